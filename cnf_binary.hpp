@@ -0,0 +1,172 @@
+// cnf_binary.hpp
+//
+// Compact binary CNF interchange format between the encoder and the
+// solver stage, replacing the text DIMACS round-trip. Layout (all
+// fields little-endian int32 in native byte order):
+//
+//   bytes 0..3   magic "SCNF"
+//   int32        version (1)
+//   int32        num_vars
+//   int32        num_clauses
+//   int32        num_literals
+//   int32[num_clauses + 1]  clause offsets into the literal array (CSR)
+//   int32[num_literals]     literals, DIMACS signed convention
+//
+// The loader mmaps the file, so "parsing" a ~9,600-clause CNF is a
+// header check plus pointer arithmetic — clause views point straight
+// into the mapping.
+
+#ifndef SUDOKU_SAT_CNF_BINARY_HPP
+#define SUDOKU_SAT_CNF_BINARY_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "clause_store.hpp"
+
+namespace sudsat {
+
+static const char CNF_BINARY_MAGIC[4] = {'S', 'C', 'N', 'F'};
+static const int32_t CNF_BINARY_VERSION = 1;
+
+// write the clauses of one or two stores (structural template + givens)
+// as a single binary CNF image to fd
+inline bool write_cnf_binary(int fd, int num_vars,
+                             const ClauseStore &a, const ClauseStore &b) {
+    int32_t num_clauses = a.size() + b.size();
+    int32_t num_literals = a.num_literals() + b.num_literals();
+
+    std::vector<char> buf;
+    buf.reserve(16 + 4 * (size_t)(num_clauses + 1) + 4 * (size_t)num_literals);
+
+    auto put32 = [&buf](int32_t v) {
+        const char *p = (const char *)&v;
+        buf.insert(buf.end(), p, p + 4);
+    };
+
+    buf.insert(buf.end(), CNF_BINARY_MAGIC, CNF_BINARY_MAGIC + 4);
+    put32(CNF_BINARY_VERSION);
+    put32(num_vars);
+    put32(num_clauses);
+    put32(num_literals);
+
+    // offsets: a's clauses first, then b's shifted by a's literal count
+    int32_t off = 0;
+    put32(off);
+    for (int i = 0; i < a.size(); ++i) {
+        off += a[i].size();
+        put32(off);
+    }
+    for (int i = 0; i < b.size(); ++i) {
+        off += b[i].size();
+        put32(off);
+    }
+
+    const char *la = (const char *)a.literals();
+    buf.insert(buf.end(), la, la + 4 * (size_t)a.num_literals());
+    const char *lb = (const char *)b.literals();
+    buf.insert(buf.end(), lb, lb + 4 * (size_t)b.num_literals());
+
+    size_t done = 0;
+    while (done < buf.size()) {
+        ssize_t n = ::write(fd, buf.data() + done, buf.size() - done);
+        if (n <= 0) {
+            return false;
+        }
+        done += (size_t)n;
+    }
+    return true;
+}
+
+// mmap-backed reader; clause(i) views point into the mapping
+class BinaryCnf {
+public:
+    BinaryCnf() {}
+    ~BinaryCnf() { close(); }
+
+    bool open(const std::string &path) {
+        close();
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd_, &st) != 0 || (size_t)st.st_size < 20) {
+            close();
+            return false;
+        }
+        size_ = (size_t)st.st_size;
+        void *p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (p == MAP_FAILED) {
+            close();
+            return false;
+        }
+        base_ = (const char *)p;
+
+        if (memcmp(base_, CNF_BINARY_MAGIC, 4) != 0) {
+            close();
+            return false;
+        }
+        const int32_t *hdr = (const int32_t *)(base_ + 4);
+        if (hdr[0] != CNF_BINARY_VERSION) {
+            close();
+            return false;
+        }
+        num_vars_ = hdr[1];
+        num_clauses_ = hdr[2];
+        num_literals_ = hdr[3];
+
+        size_t need = 20 + 4 * (size_t)(num_clauses_ + 1)
+                         + 4 * (size_t)num_literals_;
+        if (size_ < need) {
+            close();
+            return false;
+        }
+        offsets_ = (const int32_t *)(base_ + 20);
+        literals_ = (const int32_t *)(base_ + 20 + 4 * (size_t)(num_clauses_ + 1));
+        return true;
+    }
+
+    void close() {
+        if (base_) {
+            munmap((void *)base_, size_);
+            base_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    int num_vars() const { return num_vars_; }
+    int num_clauses() const { return num_clauses_; }
+
+    ClauseStore::Clause clause(int i) const {
+        return ClauseStore::Clause{(const int *)(literals_ + offsets_[i]),
+                                   (const int *)(literals_ + offsets_[i + 1])};
+    }
+
+private:
+    BinaryCnf(const BinaryCnf &);
+    BinaryCnf &operator=(const BinaryCnf &);
+
+    int fd_ = -1;
+    const char *base_ = nullptr;
+    size_t size_ = 0;
+    int32_t num_vars_ = 0;
+    int32_t num_clauses_ = 0;
+    int32_t num_literals_ = 0;
+    const int32_t *offsets_ = nullptr;
+    const int32_t *literals_ = nullptr;
+};
+
+} // namespace sudsat
+
+#endif // SUDOKU_SAT_CNF_BINARY_HPP
@@ -0,0 +1,117 @@
+// cnf_simplify.hpp
+//
+// CNF simplification over a ClauseStore: unit subsumption to a
+// fixpoint (a unit clause {l} satisfies every clause containing l and
+// strips -l everywhere, which can create new units) plus duplicate
+// elimination via sorted literal signatures. The extended encoding
+// emits the minimal and redundant constraint sets back-to-back, so
+// once the givens are applied a large fraction of its clauses are
+// subsumed or repeated — dropping them shrinks emission I/O and the
+// solver's parse and watch setup without changing the models.
+
+#ifndef SUDOKU_SAT_CNF_SIMPLIFY_HPP
+#define SUDOKU_SAT_CNF_SIMPLIFY_HPP
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "clause_store.hpp"
+
+namespace sudsat {
+
+// simplify `in` into `out` (cleared first). Returns false if the unit
+// clauses are contradictory, in which case `out` holds the empty
+// clause; otherwise `out` has the same models as `in`: the surviving
+// clauses in input order with falsified literals stripped and exact
+// duplicates removed, then one unit clause per fixed variable.
+inline bool simplify_clauses(const ClauseStore &in, int num_vars,
+                             ClauseStore &out) {
+    // val[v]: 0 unfixed, +1 true, -1 false
+    std::vector<signed char> val(num_vars + 1, 0);
+
+    bool changed = true;
+    bool conflict = false;
+    while (changed && !conflict) {
+        changed = false;
+        for (const auto &cl : in) {
+            int unfixed = 0;
+            int last = 0;
+            bool sat = false;
+            for (int lit : cl) {
+                int v = lit > 0 ? lit : -lit;
+                int sign = lit > 0 ? 1 : -1;
+                if (val[v] == 0) {
+                    ++unfixed;
+                    last = lit;
+                } else if (val[v] == sign) {
+                    sat = true;
+                    break;
+                }
+            }
+            if (sat) continue;
+            if (unfixed == 0) {
+                conflict = true;
+                break;
+            }
+            if (unfixed == 1) {
+                val[last > 0 ? last : -last] = last > 0 ? 1 : -1;
+                changed = true;
+            }
+        }
+    }
+
+    out.clear();
+    if (conflict) {
+        out.end_clause(); // empty clause: trivially UNSAT
+        return false;
+    }
+
+    // surviving clauses with falsified literals stripped, deduplicated
+    // by their sorted literal sequence (exact match, no hash-only test)
+    std::unordered_set<std::string> seen;
+    std::vector<int> key;
+    for (const auto &cl : in) {
+        bool sat = false;
+        for (int lit : cl) {
+            int v = lit > 0 ? lit : -lit;
+            if (val[v] == (lit > 0 ? 1 : -1)) {
+                sat = true;
+                break;
+            }
+        }
+        if (sat) continue;
+
+        key.clear();
+        for (int lit : cl) {
+            int v = lit > 0 ? lit : -lit;
+            if (val[v] == 0) {
+                key.push_back(lit);
+            }
+        }
+        std::sort(key.begin(), key.end());
+        std::string sig((const char *)key.data(),
+                        key.size() * sizeof(int));
+        if (!seen.insert(sig).second) {
+            continue; // duplicate of an earlier clause
+        }
+        for (int lit : key) {
+            out.push_literal(lit);
+        }
+        out.end_clause();
+    }
+
+    // unit clauses for everything the units fixed
+    for (int v = 1; v <= num_vars; ++v) {
+        if (val[v] != 0) {
+            out.add({ val[v] > 0 ? v : -v });
+        }
+    }
+    return true;
+}
+
+} // namespace sudsat
+
+#endif // SUDOKU_SAT_CNF_SIMPLIFY_HPP
@@ -0,0 +1,104 @@
+// dimacs_writer.hpp
+//
+// Buffered DIMACS CNF emitter. Formats literals with a small hand-rolled
+// itoa into one preallocated buffer (every Sudoku literal fits in 4
+// digits plus a sign) and hands the finished CNF to the kernel with a
+// single write() call, instead of ~27,000 locale-aware iostream
+// insertions per puzzle.
+
+#ifndef SUDOKU_SAT_DIMACS_WRITER_HPP
+#define SUDOKU_SAT_DIMACS_WRITER_HPP
+
+#include <cstring>
+#include <vector>
+
+#include <unistd.h>
+
+namespace sudsat {
+
+class DimacsWriter {
+public:
+    DimacsWriter() {
+        // ~9,600 clauses of two 4-digit literals comfortably fit
+        buf_.reserve(256 * 1024);
+    }
+
+    void clear() { buf_.clear(); }
+
+    // "p cnf <vars> <clauses>" problem line
+    void header(int num_vars, int num_clauses) {
+        append_raw("p cnf ", 6);
+        append_int(num_vars);
+        push(' ');
+        append_int(num_clauses);
+        push('\n');
+    }
+
+    void literal(int lit) {
+        append_int(lit);
+        push(' ');
+    }
+
+    void end_clause() {
+        push('0');
+        push('\n');
+    }
+
+    template <typename Clause>
+    void clause(const Clause &cl) {
+        for (int lit : cl) {
+            literal(lit);
+        }
+        end_clause();
+    }
+
+    const char *data() const { return buf_.data(); }
+    size_t size() const { return buf_.size(); }
+
+    // single write() of the whole buffer; returns false on a short or
+    // failed write
+    bool flush_to_fd(int fd) {
+        size_t off = 0;
+        while (off < buf_.size()) {
+            ssize_t n = ::write(fd, buf_.data() + off, buf_.size() - off);
+            if (n <= 0) {
+                return false;
+            }
+            off += (size_t)n;
+        }
+        buf_.clear();
+        return true;
+    }
+
+private:
+    void push(char c) { buf_.push_back(c); }
+
+    void append_raw(const char *s, size_t n) {
+        buf_.insert(buf_.end(), s, s + n);
+    }
+
+    // fast itoa for small integers (literals are at most 4 digits)
+    void append_int(int v) {
+        char tmp[12];
+        char *p = tmp + sizeof(tmp);
+        unsigned u = v;
+        bool neg = v < 0;
+        if (neg) {
+            u = (unsigned)(-(long long)v);
+        }
+        do {
+            *--p = (char)('0' + u % 10);
+            u /= 10;
+        } while (u);
+        if (neg) {
+            *--p = '-';
+        }
+        append_raw(p, (size_t)(tmp + sizeof(tmp) - p));
+    }
+
+    std::vector<char> buf_;
+};
+
+} // namespace sudsat
+
+#endif // SUDOKU_SAT_DIMACS_WRITER_HPP
@@ -0,0 +1,164 @@
+// propagation.hpp
+//
+// Bitmask constraint-propagation engine: candidate masks per cell with
+// naked-single and hidden-single elimination to a fixpoint. Most
+// p096-class puzzles collapse completely here in a few microseconds,
+// so the pipeline can skip CNF generation and the SAT solver entirely;
+// harder puzzles fall back to SAT with whatever propagation pinned
+// down. Also the basis of the batch driver's difficulty heuristic.
+
+#ifndef SUDOKU_SAT_PROPAGATION_HPP
+#define SUDOKU_SAT_PROPAGATION_HPP
+
+namespace sudsat {
+
+struct PropagationResult {
+    bool solved = false;        // every cell forced to a single digit
+    bool contradiction = false; // some cell lost all candidates
+    int open_cells = 0;         // cells still undetermined at fixpoint
+};
+
+// run propagation on pre-built candidate masks (bit d = digit d
+// possible; a clue is its single bit, an empty cell 0x3fe — the form
+// parse_grid81_masks produces), writing forced digits into `out`.
+// `cand` is consumed: it holds the fixpoint masks afterwards.
+inline PropagationResult propagate_cand(int cand[9][9], int out[9][9]) {
+    PropagationResult res;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        // naked singles: a fixed cell eliminates its digit from peers
+        for (int r = 0; r < 9; ++r) {
+            for (int c = 0; c < 9; ++c) {
+                int m = cand[r][c];
+                if (m == 0) {
+                    res.contradiction = true;
+                    return res;
+                }
+                if ((m & (m - 1)) != 0) {
+                    continue;
+                }
+                for (int k = 0; k < 9; ++k) {
+                    if (k != c && (cand[r][k] & m)) {
+                        cand[r][k] &= ~m;
+                        changed = true;
+                    }
+                    if (k != r && (cand[k][c] & m)) {
+                        cand[k][c] &= ~m;
+                        changed = true;
+                    }
+                }
+                int br = r / 3 * 3, bc = c / 3 * 3;
+                for (int dr = 0; dr < 3; ++dr) {
+                    for (int dc = 0; dc < 3; ++dc) {
+                        int rr = br + dr, cc = bc + dc;
+                        if ((rr != r || cc != c) && (cand[rr][cc] & m)) {
+                            cand[rr][cc] &= ~m;
+                            changed = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        // hidden singles: a digit with exactly one home in a unit
+        for (int d = 1; d <= 9; ++d) {
+            int bit = 1 << d;
+            // rows
+            for (int r = 0; r < 9; ++r) {
+                int spot = -1, n = 0;
+                for (int c = 0; c < 9 && n < 2; ++c) {
+                    if (cand[r][c] & bit) {
+                        spot = c;
+                        ++n;
+                    }
+                }
+                if (n == 0) {
+                    res.contradiction = true;
+                    return res;
+                }
+                if (n == 1 && cand[r][spot] != bit) {
+                    cand[r][spot] = bit;
+                    changed = true;
+                }
+            }
+            // columns
+            for (int c = 0; c < 9; ++c) {
+                int spot = -1, n = 0;
+                for (int r = 0; r < 9 && n < 2; ++r) {
+                    if (cand[r][c] & bit) {
+                        spot = r;
+                        ++n;
+                    }
+                }
+                if (n == 0) {
+                    res.contradiction = true;
+                    return res;
+                }
+                if (n == 1 && cand[spot][c] != bit) {
+                    cand[spot][c] = bit;
+                    changed = true;
+                }
+            }
+            // boxes
+            for (int b = 0; b < 9; ++b) {
+                int br = b / 3 * 3, bc = b % 3 * 3;
+                int sr = -1, sc = -1, n = 0;
+                for (int i = 0; i < 9 && n < 2; ++i) {
+                    int rr = br + i / 3, cc = bc + i % 3;
+                    if (cand[rr][cc] & bit) {
+                        sr = rr;
+                        sc = cc;
+                        ++n;
+                    }
+                }
+                if (n == 0) {
+                    res.contradiction = true;
+                    return res;
+                }
+                if (n == 1 && cand[sr][sc] != bit) {
+                    cand[sr][sc] = bit;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // read off the fixpoint
+    for (int r = 0; r < 9; ++r) {
+        for (int c = 0; c < 9; ++c) {
+            int m = cand[r][c];
+            if ((m & (m - 1)) == 0) {
+                // single candidate: bit index is the digit
+                int d = 0;
+                while ((m >>= 1) != 0) {
+                    ++d;
+                }
+                out[r][c] = d;
+            } else {
+                out[r][c] = 0;
+                ++res.open_cells;
+            }
+        }
+    }
+    res.solved = res.open_cells == 0;
+    return res;
+}
+
+// run propagation on `in` (0 = empty) and write the forced digits into
+// `out` (0 for cells still open). `in` and `out` may alias.
+inline PropagationResult propagate_grid(const int in[9][9], int out[9][9]) {
+    // cand[r][c]: bitmask of possible digits (bit d = digit d)
+    int cand[9][9];
+    for (int r = 0; r < 9; ++r) {
+        for (int c = 0; c < 9; ++c) {
+            cand[r][c] = in[r][c] != 0 ? (1 << in[r][c]) : 0x3fe;
+        }
+    }
+    return propagate_cand(cand, out);
+}
+
+} // namespace sudsat
+
+#endif // SUDOKU_SAT_PROPAGATION_HPP
@@ -6,10 +6,20 @@
 #include <fstream>
 #include <cstring>
 #include <cctype>
+#include <tuple>
 #include <utility>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "timing.hpp"
+
 using namespace std;
 
+// --timing: per-stage wall times, dumped on stderr at exit
+sudsat::StageTimings timings;
+
 static const int NUM_ROWS = 9;
 static const int NUM_COLS = 9;
 static const int NUM_DIGITS = 9;
@@ -25,22 +35,188 @@ tuple<int,int,int> inv_varnum(int v) {
     return make_tuple(r, c, d);
 }
 
+// precomputed decode tables: variable -> byte offset in the 90-byte
+// output frame (81 digits + 9 newlines) and variable -> digit char,
+// so batch decoding avoids the per-variable div/mod of inv_varnum()
+struct DecodeTables {
+    int pos[NUM_VARS + 1];
+    char digit[NUM_VARS + 1];
+
+    DecodeTables() {
+        for (int v = 1; v <= NUM_VARS; ++v) {
+            int r, c, d;
+            tie(r, c, d) = inv_varnum(v);
+            pos[v] = (r - 1) * 10 + (c - 1); // row r ends with a newline
+            digit[v] = (char)('0' + d);
+        }
+    }
+};
+
+static const DecodeTables tables;
+
+// decode one assignment (positive literals only — there are exactly 81,
+// one per cell) into a 90-byte frame and write it to out
+void decode_positives(const vector<int> &lits, ostream &out) {
+    char frame[91];
+    memset(frame, '0', 90);
+    for (int r = 0; r < 9; ++r) {
+        frame[r * 10 + 9] = '\n';
+    }
+    for (int x : lits) {
+        if (x > 0 && x <= NUM_VARS) {
+            frame[tables.pos[x]] = tables.digit[x];
+        }
+    }
+    out.write(frame, 90);
+}
+
+// fast assignment parser: scans the raw buffer for whitespace-separated
+// literals up to the terminating 0, appending only the positive ones
+// (negatives never place a digit). With SSE2, runs of separator bytes
+// are skipped 16 at a time via a compare + movemask instead of a
+// per-character loop; digit runs are at most 4 chars, so the value
+// accumulates in a short unrolled loop either way. Returns the position
+// just past the terminating 0, or end if none was found.
+const char *parse_positives(const char *p, const char *end,
+                            vector<int> &out) {
+    while (p < end) {
+#ifdef __SSE2__
+        // skip separators (anything below '-') 16 bytes at a time
+        while (end - p >= 16) {
+            __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+            // token chars are '-' (0x2d) and '0'..'9' (>= 0x30);
+            // separators (' ', '\n', '\r', '\t') are all below 0x2d
+            __m128i thresh = _mm_set1_epi8('-' - 1);
+            int mask = _mm_movemask_epi8(_mm_cmpgt_epi8(chunk, thresh));
+            if (mask != 0) {
+                p += __builtin_ctz(mask);
+                break;
+            }
+            p += 16;
+        }
+#endif
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r'
+                           || *p == '\t')) {
+            ++p;
+        }
+        if (p >= end) {
+            break;
+        }
+
+        bool neg = (*p == '-');
+        if (neg) {
+            ++p;
+        }
+        int v = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            v = v * 10 + (*p - '0');
+            ++p;
+        }
+        if (v == 0) {
+            return p; // 0 terminates the assignment list
+        }
+        if (!neg) {
+            out.push_back(v);
+        }
+    }
+    return end;
+}
+
+// batch mode: decode many minisat result blocks from one stream.
+// Each block is a "SAT" line followed by the assignment line, or a
+// single "UNSAT" line. Solutions are printed back-to-back in input
+// order; UNSAT blocks are reported on stderr and skipped.
+int run_batch_decode(istream &in) {
+    // slurp the whole stream once and parse it in place — no per-line
+    // string copies and no stringstream extraction
+    string buf;
+    {
+        auto t = timings.scope("read");
+        buf.assign(istreambuf_iterator<char>(in),
+                   istreambuf_iterator<char>());
+    }
+    const char *p = buf.data();
+    const char *end = p + buf.size();
+
+    int block = 0;
+    int failures = 0;
+    vector<int> lits;
+    lits.reserve(81);
+
+    while (p < end) {
+        while (p < end && isspace((unsigned char)*p)) {
+            ++p;
+        }
+        if (p >= end) {
+            break;
+        }
+        ++block;
+
+        if (end - p >= 5 && memcmp(p, "UNSAT", 5) == 0) {
+            cerr << "UNSAT: block " << block << " has no solution.\n";
+            ++failures;
+            p += 5;
+            continue;
+        }
+        if (end - p >= 3 && memcmp(p, "SAT", 3) == 0) {
+            p += 3;
+            lits.clear();
+            {
+                auto t = timings.scope("parse");
+                p = parse_positives(p, end, lits);
+            }
+            {
+                auto t = timings.scope("decode");
+                decode_positives(lits, cout);
+            }
+            continue;
+        }
+
+        cerr << "Error: expected SAT or UNSAT at block " << block << "\n";
+        return 1;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
+
 int main(int argc, char *argv[]) {
     ios::sync_with_stdio(false);
     cin.tie(nullptr);
 
+    // Usage: sat2sud [--batch] [--timing] [assignfile]
     // read from STDIN by default; if a filename is given, read from that file.
+    // --batch decodes many SAT/UNSAT result blocks from one stream;
+    // --timing dumps per-stage wall times on stderr as one key=value line.
+    bool batch = false;
+    string filename;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--batch") {
+            batch = true;
+        } else if (arg == "--timing") {
+            timings.enabled = true;
+        } else {
+            filename = arg;
+        }
+    }
+
     istream *in = &cin;
     static ifstream fin;
-    if (argc > 1) {
-        fin.open(argv[1]);
+    if (!filename.empty()) {
+        fin.open(filename.c_str());
         if (!fin) {
-            cerr << "Error: cannot open assignment file " << argv[1] << "\n";
+            cerr << "Error: cannot open assignment file " << filename << "\n";
             return 1;
         }
         in = &fin;
     }
 
+    if (batch) {
+        int rc = run_batch_decode(*in);
+        timings.report(cerr);
+        return rc;
+    }
+
     // read first line: SAT or UNSAT
     string firstLine;
     if (!std::getline(*in, firstLine)) {
@@ -68,6 +244,7 @@ int main(int argc, char *argv[]) {
 
     vector<int> ints;
     {
+        auto t = timings.scope("parse");
         stringstream ss(secondLine);
         int val;
         while (ss >> val) {
@@ -76,36 +253,41 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    // build valuation array for variables 
-    // val[i] = 0 unset, 1 true, -1 false
-    vector<int> val(NUM_VARS + 1, 0);
-    for (int x : ints) {
-        if (x > 0 && x <= NUM_VARS) {
-            val[x] = 1;
-        } else if (x < 0 && -x <= NUM_VARS) {
-            val[-x] = -1;
+    {
+        auto t = timings.scope("decode");
+
+        // build valuation array for variables
+        // val[i] = 0 unset, 1 true, -1 false
+        vector<int> val(NUM_VARS + 1, 0);
+        for (int x : ints) {
+            if (x > 0 && x <= NUM_VARS) {
+                val[x] = 1;
+            } else if (x < 0 && -x <= NUM_VARS) {
+                val[-x] = -1;
+            }
         }
-    }
 
-    // decode true variables into Sudoku grid
-    int grid[9][9];
-    memset(grid, 0, sizeof(grid));
+        // decode true variables into Sudoku grid
+        int grid[9][9];
+        memset(grid, 0, sizeof(grid));
 
-    for (int v = 1; v <= NUM_VARS; ++v) {
-        if (val[v] == 1) {
-            int r, c, d;
-            tie(r, c, d) = inv_varnum(v);  // use your existing inv_varnum
-            grid[r - 1][c - 1] = d;
+        for (int v = 1; v <= NUM_VARS; ++v) {
+            if (val[v] == 1) {
+                int r, c, d;
+                tie(r, c, d) = inv_varnum(v);  // use your existing inv_varnum
+                grid[r - 1][c - 1] = d;
+            }
         }
-    }
 
-    // print solved Sudoku: 9 lines of 9 digits
-    for (int r = 0; r < 9; ++r) {
-        for (int c = 0; c < 9; ++c) {
-            cout << grid[r][c];
+        // print solved Sudoku: 9 lines of 9 digits
+        for (int r = 0; r < 9; ++r) {
+            for (int c = 0; c < 9; ++c) {
+                cout << grid[r][c];
+            }
+            cout << "\n";
         }
-        cout << "\n";
     }
 
+    timings.report(cerr);
     return 0;
 }
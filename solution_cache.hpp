@@ -0,0 +1,76 @@
+// solution_cache.hpp
+//
+// Content-addressed solution cache: the canonicalized 81-character
+// puzzle is the key, the 81-digit solution the value. Lookups hit an
+// in-memory table; an optional backing file makes entries persistent
+// across runs — it is loaded on open and appended on every insert, one
+// "puzzle solution" pair per line, so a warm cache survives restarts
+// and can be shared between the daemon and one-shot invocations.
+
+#ifndef SUDOKU_SAT_SOLUTION_CACHE_HPP
+#define SUDOKU_SAT_SOLUTION_CACHE_HPP
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+
+namespace sudsat {
+
+class SolutionCache {
+public:
+    // canonical form of a parsed grid: digits for clues, '.' for empty
+    // cells, so "0", ".", "*" and "?" spellings of the same puzzle
+    // share one entry
+    static std::string canonical(const int grid[9][9]) {
+        std::string key(81, '.');
+        for (int r = 0; r < 9; ++r) {
+            for (int c = 0; c < 9; ++c) {
+                if (grid[r][c] != 0) {
+                    key[r * 9 + c] = (char)('0' + grid[r][c]);
+                }
+            }
+        }
+        return key;
+    }
+
+    // attach a persistent backing file, loading any existing entries.
+    // Returns false only if the file exists but cannot be read.
+    bool open(const std::string &path) {
+        std::ifstream in(path.c_str());
+        if (in) {
+            std::string key, sol;
+            while (in >> key >> sol) {
+                if (key.size() == 81 && sol.size() == 81) {
+                    table_[key] = sol;
+                }
+            }
+        }
+        out_.open(path.c_str(), std::ios::app);
+        return (bool)out_;
+    }
+
+    // returns the cached 81-digit solution, or nullptr on a miss
+    const std::string *lookup(const std::string &key) const {
+        auto it = table_.find(key);
+        return it != table_.end() ? &it->second : nullptr;
+    }
+
+    void insert(const std::string &key, const std::string &sol) {
+        if (!table_.insert(std::make_pair(key, sol)).second) {
+            return; // already cached; nothing to persist
+        }
+        if (out_) {
+            out_ << key << " " << sol << "\n" << std::flush;
+        }
+    }
+
+    size_t size() const { return table_.size(); }
+
+private:
+    std::unordered_map<std::string, std::string> table_;
+    std::ofstream out_;
+};
+
+} // namespace sudsat
+
+#endif // SUDOKU_SAT_SOLUTION_CACHE_HPP
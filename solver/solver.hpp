@@ -0,0 +1,448 @@
+// solver.hpp
+//
+// Small embedded CDCL SAT solver so the pipeline can solve the Sudoku
+// CNF in-process instead of shelling out to minisat and round-tripping
+// the formula through DIMACS text files.
+//
+// Literals use the DIMACS convention at the interface (+v / -v); the
+// model returned by solve() is indexed by variable number 1..num_vars.
+
+#ifndef SUDOKU_SAT_SOLVER_HPP
+#define SUDOKU_SAT_SOLVER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <vector>
+
+namespace sudsat {
+
+class Solver {
+public:
+    explicit Solver(int num_vars)
+        : nvars_(num_vars),
+          assign_(num_vars + 1, 0),
+          level_(num_vars + 1, 0),
+          reason_(num_vars + 1, -1),
+          activity_(num_vars + 1, 0.0),
+          phase_(num_vars + 1, false),
+          seen_(num_vars + 1, 0),
+          watches_(2 * (num_vars + 1)) {
+        trail_.reserve(num_vars);
+    }
+
+    // add one clause in DIMACS literals; returns false if the clause
+    // makes the formula trivially unsatisfiable (empty clause or a unit
+    // conflicting with an earlier unit)
+    bool add_clause(const std::vector<int> &lits) {
+        return add_clause(lits.data(), (int)lits.size());
+    }
+
+    bool add_clause(const int *lits, int n) {
+        std::vector<int> cl;
+        cl.reserve(n);
+        for (int i = 0; i < n; ++i) {
+            int lit = lits[i];
+            int v = std::abs(lit);
+            // drop literals already false at level 0, skip satisfied clauses
+            int val = value(lit);
+            if (val == 1) return true;   // already satisfied
+            if (val == -1) continue;     // already false, drop literal
+            cl.push_back(lit);
+            (void)v;
+        }
+
+        if (cl.empty()) {
+            ok_ = false;
+            return false;
+        }
+        if (cl.size() == 1) {
+            // top-level unit: enqueue immediately
+            if (!enqueue(cl[0], -1)) {
+                ok_ = false;
+                return false;
+            }
+            input_trail_end_ = (int)trail_.size();
+            return true;
+        }
+
+        attach_clause(cl);
+        input_bin_end_ = (int)bin_lits_.size();
+        input_long_end_ = (int)long_off_.size() - 1;
+        input_trail_end_ = (int)trail_.size();
+        return true;
+    }
+
+    // export everything learnt since the input clauses were loaded:
+    // level-0 facts derived during search as unit clauses, plus every
+    // learnt binary and longer clause. Learnt clauses are derived by
+    // resolution over the clause database only, so when the givens
+    // were passed as assumptions (never as clauses) the export is
+    // implied by the structural CNF alone and can be preloaded into
+    // any solver sharing it. Store needs push_literal()/end_clause(),
+    // i.e. a ClauseStore.
+    template <typename Store>
+    void export_learnts(Store &out) const {
+        for (int i = input_trail_end_; i < (int)trail_.size(); ++i) {
+            out.push_literal(trail_[i]);
+            out.end_clause();
+        }
+        for (int p = input_bin_end_; p + 1 < (int)bin_lits_.size();
+             p += 2) {
+            out.push_literal(bin_lits_[p]);
+            out.push_literal(bin_lits_[p + 1]);
+            out.end_clause();
+        }
+        for (int i = input_long_end_; i + 1 < (int)long_off_.size();
+             ++i) {
+            for (int k = long_off_[i]; k < long_off_[i + 1]; ++k) {
+                out.push_literal(long_lits_[k]);
+            }
+            out.end_clause();
+        }
+    }
+
+    // solve the formula; returns true if SAT. On SAT, model(v) gives the
+    // value of variable v.
+    bool solve() {
+        static const std::vector<int> no_assumptions;
+        return solve(no_assumptions);
+    }
+
+    // incremental interface: solve under the given assumption literals.
+    // The clause database (including everything learnt on earlier
+    // calls) is kept, and the solver backtracks to level 0 afterwards,
+    // so one instance loaded with the structural clauses can solve a
+    // whole batch of puzzles — each puzzle's givens passed as
+    // assumptions instead of unit clauses. Returns false if the formula
+    // is unsatisfiable under the assumptions; the solver stays usable
+    // unless it was unsatisfiable outright.
+    // cooperative cancellation: when the flag becomes true, solve()
+    // aborts at the next iteration and returns false with interrupted()
+    // set. Used by the portfolio race to cancel the losing solver.
+    void set_interrupt(const std::atomic<bool> *flag) { interrupt_ = flag; }
+    bool interrupted() const { return interrupted_; }
+
+    bool solve(const std::vector<int> &assumptions) {
+        if (!ok_) return false;
+
+        interrupted_ = false;
+        backtrack(0);
+
+        for (;;) {
+            if (interrupt_ &&
+                interrupt_->load(std::memory_order_relaxed)) {
+                interrupted_ = true;
+                backtrack(0);
+                return false;
+            }
+
+            int confl = propagate();
+            if (confl != -1) {
+                ++stats_conflicts_;
+                if (decision_level() == 0) {
+                    ok_ = false;
+                    return false;
+                }
+                std::vector<int> learnt;
+                int back_level = analyze(confl, learnt);
+                backtrack(back_level);
+                if (learnt.size() == 1) {
+                    backtrack(0);
+                    enqueue(learnt[0], -1);
+                } else {
+                    int ci = attach_clause(learnt);
+                    enqueue(learnt[0], ci);
+                }
+                decay_activity();
+                continue;
+            }
+
+            // establish the next pending assumption, if any
+            if (decision_level() < (int)assumptions.size()) {
+                int p = assumptions[decision_level()];
+                int val = value(p);
+                if (val == -1) {
+                    // an earlier assumption (or a learnt clause)
+                    // contradicts this one: UNSAT under assumptions
+                    backtrack(0);
+                    return false;
+                }
+                trail_lim_.push_back((int)trail_.size());
+                if (val == 0) {
+                    enqueue(p, -1);
+                }
+                continue;
+            }
+
+            int next = pick_branch_var();
+            if (next == 0) {
+                // all variables assigned: snapshot the model so the
+                // caller can read it after we backtrack
+                model_.assign(assign_.begin(), assign_.end());
+                backtrack(0);
+                return true;
+            }
+            ++stats_decisions_;
+            trail_lim_.push_back((int)trail_.size());
+            enqueue(phase_[next] ? next : -next, -1);
+        }
+    }
+
+    // model value of variable v after a SAT answer: +1 true, -1 false
+    int model(int v) const { return model_[v]; }
+
+    long long conflicts() const { return stats_conflicts_; }
+    long long decisions() const { return stats_decisions_; }
+    long long propagations() const { return stats_propagations_; }
+
+private:
+    // internal literal encoding: 2*v for +v, 2*v+1 for -v
+    static int enc(int lit) {
+        return lit > 0 ? 2 * lit : -2 * lit + 1;
+    }
+    static int dec(int elit) {
+        return (elit & 1) ? -(elit >> 1) : (elit >> 1);
+    }
+
+    int value(int lit) const {
+        int a = assign_[std::abs(lit)];
+        return lit > 0 ? a : -a;
+    }
+
+    int decision_level() const { return (int)trail_lim_.size(); }
+
+    // clause storage is segregated by length: over 95% of the encoding
+    // is binary (every at-most-one builder emits pairs), so pairs live
+    // in one flat array and longer clauses in a CSR literal array —
+    // propagation walks contiguous memory instead of chasing one heap
+    // vector per clause. Clause ids are even for binary (the pair's
+    // offset in bin_lits_) and odd for long (2 * index + 1), so both
+    // arrays grow independently without disturbing existing ids.
+    int *clause_lits(int ci) {
+        return (ci & 1) ? &long_lits_[long_off_[ci >> 1]]
+                        : &bin_lits_[ci];
+    }
+    int clause_size(int ci) const {
+        return (ci & 1) ? long_off_[(ci >> 1) + 1] - long_off_[ci >> 1]
+                        : 2;
+    }
+
+    int attach_clause(const std::vector<int> &cl) {
+        int ci;
+        if ((int)cl.size() == 2) {
+            ci = (int)bin_lits_.size(); // even
+            bin_lits_.push_back(cl[0]);
+            bin_lits_.push_back(cl[1]);
+        } else {
+            ci = 2 * ((int)long_off_.size() - 1) + 1; // odd
+            long_lits_.insert(long_lits_.end(), cl.begin(), cl.end());
+            long_off_.push_back((int)long_lits_.size());
+        }
+        const int *lits = clause_lits(ci);
+        watches_[enc(lits[0])].push_back(ci);
+        watches_[enc(lits[1])].push_back(ci);
+        return ci;
+    }
+
+    // set lit true with the given reason clause index (-1 = decision/unit)
+    bool enqueue(int lit, int reason) {
+        int v = std::abs(lit);
+        if (assign_[v] != 0) {
+            return value(lit) == 1;
+        }
+        assign_[v] = lit > 0 ? 1 : -1;
+        level_[v] = decision_level();
+        reason_[v] = reason;
+        phase_[v] = lit > 0;
+        trail_.push_back(lit);
+        return true;
+    }
+
+    // unit propagation over watched literals; returns conflicting clause
+    // index or -1
+    int propagate() {
+        while (qhead_ < (int)trail_.size()) {
+            int lit = trail_[qhead_++];
+            ++stats_propagations_;
+            int falsified = enc(-lit);
+            std::vector<int> &ws = watches_[falsified];
+
+            int keep = 0;
+            for (int i = 0; i < (int)ws.size(); ++i) {
+                int ci = ws[i];
+                int *cl = clause_lits(ci);
+                int n = clause_size(ci);
+
+                // make sure the falsified literal sits in slot 1
+                if (cl[0] == -lit) std::swap(cl[0], cl[1]);
+
+                if (value(cl[0]) == 1) {
+                    ws[keep++] = ci; // clause satisfied, keep watch
+                    continue;
+                }
+
+                // look for a replacement watch (binary clauses have
+                // none: n == 2 skips the scan entirely)
+                bool moved = false;
+                for (int k = 2; k < n; ++k) {
+                    if (value(cl[k]) != -1) {
+                        std::swap(cl[1], cl[k]);
+                        watches_[enc(cl[1])].push_back(ci);
+                        moved = true;
+                        break;
+                    }
+                }
+                if (moved) continue;
+
+                // clause is unit or conflicting
+                ws[keep++] = ci;
+                if (!enqueue(cl[0], ci)) {
+                    // conflict: keep the remaining watches and bail out
+                    for (int j = i + 1; j < (int)ws.size(); ++j) {
+                        ws[keep++] = ws[j];
+                    }
+                    ws.resize(keep);
+                    qhead_ = (int)trail_.size();
+                    return ci;
+                }
+            }
+            ws.resize(keep);
+        }
+        return -1;
+    }
+
+    // first-UIP conflict analysis; fills learnt (learnt[0] is the
+    // asserting literal) and returns the backtrack level
+    int analyze(int confl, std::vector<int> &learnt) {
+        learnt.clear();
+        learnt.push_back(0); // slot for the asserting literal
+
+        int counter = 0;
+        int lit = 0;
+        int index = (int)trail_.size() - 1;
+
+        do {
+            const int *cl = clause_lits(confl);
+            int n = clause_size(confl);
+            int start = (lit == 0) ? 0 : 1;
+            for (int k = start; k < n; ++k) {
+                int q = cl[k];
+                int v = std::abs(q);
+                if (!seen_[v] && level_[v] > 0) {
+                    seen_[v] = 1;
+                    bump_activity(v);
+                    if (level_[v] == decision_level()) {
+                        ++counter;
+                    } else {
+                        learnt.push_back(q);
+                    }
+                }
+            }
+
+            // pick the next trail literal to resolve on
+            while (!seen_[std::abs(trail_[index])]) --index;
+            lit = trail_[index--];
+            seen_[std::abs(lit)] = 0;
+            confl = reason_[std::abs(lit)];
+            --counter;
+        } while (counter > 0);
+
+        learnt[0] = -lit;
+
+        // backtrack level = highest level among the other learnt literals
+        int back = 0;
+        int pos = 1;
+        for (int k = 1; k < (int)learnt.size(); ++k) {
+            int lv = level_[std::abs(learnt[k])];
+            if (lv > back) {
+                back = lv;
+                pos = k;
+            }
+        }
+        if ((int)learnt.size() > 1) {
+            std::swap(learnt[1], learnt[pos]);
+        }
+
+        for (int k = 0; k < (int)learnt.size(); ++k) {
+            seen_[std::abs(learnt[k])] = 0;
+        }
+        return back;
+    }
+
+    void backtrack(int level) {
+        if ((int)trail_lim_.size() <= level) {
+            return; // already there; keep pending propagations queued
+        }
+        while ((int)trail_lim_.size() > level) {
+            int bound = trail_lim_.back();
+            trail_lim_.pop_back();
+            while ((int)trail_.size() > bound) {
+                int v = std::abs(trail_.back());
+                assign_[v] = 0;
+                reason_[v] = -1;
+                trail_.pop_back();
+            }
+        }
+        qhead_ = (int)trail_.size();
+    }
+
+    // pick the unassigned variable with the highest activity (0 = none)
+    int pick_branch_var() {
+        int best = 0;
+        double best_act = -1.0;
+        for (int v = 1; v <= nvars_; ++v) {
+            if (assign_[v] == 0 && activity_[v] > best_act) {
+                best_act = activity_[v];
+                best = v;
+            }
+        }
+        return best;
+    }
+
+    void bump_activity(int v) {
+        activity_[v] += act_inc_;
+        if (activity_[v] > 1e100) {
+            for (int u = 1; u <= nvars_; ++u) activity_[u] *= 1e-100;
+            act_inc_ *= 1e-100;
+        }
+    }
+
+    void decay_activity() { act_inc_ *= (1.0 / 0.95); }
+
+    int nvars_;
+    bool ok_ = true;
+    int qhead_ = 0;
+    const std::atomic<bool> *interrupt_ = nullptr;
+    bool interrupted_ = false;
+
+    // high-water marks after the last input clause, so everything
+    // beyond them is learnt (see export_learnts)
+    int input_bin_end_ = 0;
+    int input_long_end_ = 0;
+    int input_trail_end_ = 0;
+
+    std::vector<int> bin_lits_;      // flat literal pairs, clause id even
+    std::vector<int> long_lits_;     // CSR literals of longer clauses
+    std::vector<int> long_off_{0};   // clause id 2*i+1 spans
+                                     // long_lits_[long_off_[i]..[i+1])
+    std::vector<int> assign_;   // 0 unset, +1 true, -1 false
+    std::vector<int> level_;
+    std::vector<int> reason_;   // clause index, -1 for decisions/units
+    std::vector<double> activity_;
+    std::vector<bool> phase_;   // saved phases for branching
+    std::vector<char> seen_;    // scratch for analyze()
+    std::vector<std::vector<int>> watches_; // indexed by encoded literal
+    std::vector<int> trail_;
+    std::vector<int> trail_lim_;
+    std::vector<int> model_;    // snapshot of the last SAT assignment
+
+    double act_inc_ = 1.0;
+    long long stats_conflicts_ = 0;
+    long long stats_decisions_ = 0;
+    long long stats_propagations_ = 0;
+};
+
+} // namespace sudsat
+
+#endif // SUDOKU_SAT_SOLVER_HPP
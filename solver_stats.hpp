@@ -0,0 +1,112 @@
+// solver_stats.hpp
+//
+// Structured per-puzzle solver statistics, replacing the per-run
+// stat.txt text files that test_harness.py regex-scrapes. Each solve
+// contributes one record (conflicts, decisions, propagations, solve
+// time); a sink writes them as CSV or JSON lines keyed by file
+// extension, and an aggregator reports distributions across the run.
+
+#ifndef SUDOKU_SAT_SOLVER_STATS_HPP
+#define SUDOKU_SAT_SOLVER_STATS_HPP
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sudsat {
+
+struct SolveStats {
+    int puzzle = 0;          // 1-based input position
+    bool sat = false;
+    long long conflicts = 0;
+    long long decisions = 0;
+    long long propagations = 0;
+    long long solve_ns = 0;
+};
+
+class StatsSink {
+public:
+    // format is chosen by extension: .jsonl for JSON lines, anything
+    // else is CSV
+    bool open(const std::string &path) {
+        jsonl_ = path.size() > 6 &&
+                 path.compare(path.size() - 6, 6, ".jsonl") == 0;
+        out_.open(path.c_str());
+        if (!out_) {
+            return false;
+        }
+        if (!jsonl_) {
+            out_ << "puzzle,sat,conflicts,decisions,propagations,solve_us\n";
+        }
+        return true;
+    }
+
+    // thread-safe: workers from the batch driver record concurrently
+    void add(const SolveStats &s) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        rows_.push_back(s);
+        if (out_.is_open()) {
+            if (jsonl_) {
+                out_ << "{\"puzzle\":" << s.puzzle
+                     << ",\"sat\":" << (s.sat ? "true" : "false")
+                     << ",\"conflicts\":" << s.conflicts
+                     << ",\"decisions\":" << s.decisions
+                     << ",\"propagations\":" << s.propagations
+                     << ",\"solve_us\":" << s.solve_ns / 1000 << "}\n";
+            } else {
+                out_ << s.puzzle << "," << (s.sat ? 1 : 0) << ","
+                     << s.conflicts << "," << s.decisions << ","
+                     << s.propagations << "," << s.solve_ns / 1000 << "\n";
+            }
+        }
+    }
+
+    // distribution summary across all recorded solves
+    void summarize(std::ostream &os) const {
+        if (rows_.empty()) {
+            os << "stats: no solves recorded\n";
+            return;
+        }
+        os << "stats: " << rows_.size() << " puzzles\n";
+        print_dist(os, "conflicts   ",
+                   [](const SolveStats &s) { return s.conflicts; });
+        print_dist(os, "decisions   ",
+                   [](const SolveStats &s) { return s.decisions; });
+        print_dist(os, "propagations",
+                   [](const SolveStats &s) { return s.propagations; });
+        print_dist(os, "solve_us    ",
+                   [](const SolveStats &s) { return s.solve_ns / 1000; });
+    }
+
+private:
+    template <typename Get>
+    void print_dist(std::ostream &os, const char *name, Get get) const {
+        std::vector<long long> v;
+        v.reserve(rows_.size());
+        long long total = 0;
+        for (const SolveStats &s : rows_) {
+            v.push_back(get(s));
+            total += v.back();
+        }
+        std::sort(v.begin(), v.end());
+        size_t n = v.size();
+        os << "  " << name
+           << " min=" << v.front()
+           << " median=" << v[n / 2]
+           << " p99=" << v[std::min(n - 1, n * 99 / 100)]
+           << " max=" << v.back()
+           << " mean=" << total / (long long)n << "\n";
+    }
+
+    std::ofstream out_;
+    bool jsonl_ = false;
+    mutable std::mutex mtx_;
+    std::vector<SolveStats> rows_;
+};
+
+} // namespace sudsat
+
+#endif // SUDOKU_SAT_SOLVER_STATS_HPP
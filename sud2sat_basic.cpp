@@ -8,6 +8,16 @@
 #include <cctype>
 #include <utility>
 
+#include <fcntl.h>
+
+#include "clause_store.hpp"
+#include "cnf_binary.hpp"
+#include "dimacs_writer.hpp"
+#include "puzzle_source.hpp"
+#include "solver/solver.hpp"
+#include "sudoku_encoding.hpp"
+#include "timing.hpp"
+
 using namespace std;
 
 static const int NUM_ROWS = 9;
@@ -18,156 +28,465 @@ static const int NUM_VARS = NUM_ROWS * NUM_COLS * NUM_DIGITS; // 729
 // convert it to decimal representation
 int varnum(int r, int c, int d) {
     // r,c,d in [1..9]
-    return 81 * (r - 1) + 9 * (c - 1) + d;
+    return sudsat::Encoding9::varnum(r, c, d);
 }
 
-vector<vector<int>> clauses;
+// --amo: at-most-one strategy for the structural constraints.
+// pairwise is the historical encoding; sequential and commander trade
+// auxiliary variables for a linear clause count per group.
+sudsat::Encoding9::AmoKind opt_amo = sudsat::Encoding9::AMO_PAIRWISE;
 
-// encoding builders
-// check if the cell has at least one number
-void add_cell_at_least_one() {
-    // For each cell (r,c): (s_rc1 ∨ ... ∨ s_rc9)
-    for (int r = 1; r <= NUM_ROWS; ++r) {
-        for (int c = 1; c <= NUM_COLS; ++c) {
-            vector<int> clause;
-            clause.reserve(NUM_DIGITS);
-            for (int d = 1; d <= NUM_DIGITS; ++d) {
-                clause.push_back(varnum(r, c, d));
-            }
-            clauses.push_back(move(clause));
+// total variable count of the current encoding (729 plus any
+// at-most-one auxiliaries); set when the template is built
+int total_vars = NUM_VARS;
+
+// --timing: per-stage wall times, dumped on stderr at exit
+sudsat::StageTimings timings;
+
+// the structural clauses (everything except the givens) are identical
+// for every puzzle, so build them exactly once on first use and share
+// the template across all puzzles in a batch
+const sudsat::ClauseStore &structural_clauses() {
+    static sudsat::ClauseStore tmpl = [] {
+        auto t = timings.scope("template");
+        sudsat::ClauseStore cs;
+        if (opt_amo == sudsat::Encoding9::AMO_PAIRWISE) {
+            // keeps the historical clause order exactly
+            sudsat::Encoding9::add_structural(cs);
+        } else {
+            total_vars = sudsat::Encoding9::add_structural_amo(cs, opt_amo);
         }
+        return cs;
+    }();
+    return tmpl;
+}
+
+// per-puzzle unit clauses for the clues
+sudsat::ClauseStore givens;
+
+// --propagate: apply givens at encode time and emit the reduced CNF
+bool opt_propagate = false;
+
+// add the givens to the clauses
+void add_givens(const int grid[9][9]) {
+    // Unit clauses for clues.
+    givens.clear();
+    sudsat::Encoding9::add_givens(&grid[0][0], givens);
+}
+
+// map 81 already-stripped characters into grid[row][col]
+bool fill_grid81(const char *all, int grid[9][9]) {
+    if (!sudsat::parse_grid81(all, grid)) {
+        cerr << "Error: invalid character in puzzle\n";
+        return false;
     }
+    return true;
 }
 
-void add_row_at_most_one() {
-    // For each row r, digit d, columns c1 < c2:
-    // (¬s_r c1 d ∨ ¬s_r c2 d)
-    for (int r = 1; r <= NUM_ROWS; ++r) {
-        for (int d = 1; d <= NUM_DIGITS; ++d) {
-            for (int c1 = 1; c1 < NUM_COLS; ++c1) {
-                for (int c2 = c1 + 1; c2 <= NUM_COLS; ++c2) {
-                    clauses.push_back({
-                        -varnum(r, c1, d),
-                        -varnum(r, c2, d)
-                    });
-                }
+bool fill_grid(const string &all, int grid[9][9]) {
+    if ((int)all.size() != 81) {
+        cerr << "Error: expected exactly 81 non-whitespace characters, got "
+             << all.size() << "\n";
+        return false;
+    }
+    return fill_grid81(all.data(), grid);
+}
+
+bool read_grid(istream &in, int grid[9][9]) {
+    string all;
+    string line;
+
+    // Read all lines and strip whitespace globally
+    while (getline(in, line)) {
+        for (unsigned char ch : line) {
+            if (!isspace(ch)) {
+                all.push_back(ch);
             }
         }
     }
+
+    return fill_grid(all, grid);
 }
 
-void add_col_at_most_one() {
-    // For each column c, digit d, rows r1 < r2:
-    // (¬s_r1 c d ∨ ¬s_r2 c d)
-    for (int c = 1; c <= NUM_COLS; ++c) {
-        for (int d = 1; d <= NUM_DIGITS; ++d) {
-            for (int r1 = 1; r1 < NUM_ROWS; ++r1) {
-                for (int r2 = r1 + 1; r2 <= NUM_ROWS; ++r2) {
-                    clauses.push_back({
-                        -varnum(r1, c, d),
-                        -varnum(r2, c, d)
-                    });
-                }
+
+// apply the givens to the structural clauses by unit propagation and
+// collect the surviving formula into `out`: satisfied clauses are
+// dropped, falsified literals are removed, and every variable fixed by
+// propagation is emitted as a unit clause (so the reduced CNF has the
+// same models as the full one). Returns false if the givens are
+// contradictory, in which case `out` holds the empty clause.
+bool build_propagated(const int grid[9][9], sudsat::ClauseStore &out) {
+    const sudsat::ClauseStore &tmpl = structural_clauses();
+
+    // val[v]: 0 unfixed, +1 true, -1 false
+    static vector<signed char> val;
+    val.assign(total_vars + 1, 0);
+    for (int r = 1; r <= NUM_ROWS; ++r) {
+        for (int c = 1; c <= NUM_COLS; ++c) {
+            int d = grid[r-1][c-1];
+            if (1 <= d && d <= 9) {
+                val[varnum(r, c, d)] = 1;
             }
         }
     }
-}
 
-void add_box_at_most_one() {
-    // For each 3x3 box and digit d, for each pair of cells:
-    // (¬s_r1 c1 d ∨ ¬s_r2 c2 d)
-    for (int br = 0; br < 3; ++br) {
-        for (int bc = 0; bc < 3; ++bc) {
-            // build a list of the 9 cells in the box
-            vector<pair<int,int>> cells;
-            cells.reserve(9);
-            for (int dr = 0; dr < 3; ++dr) {
-                for (int dc = 0; dc < 3; ++dc) {
-                    int r = 3 * br + dr + 1;
-                    int c = 3 * bc + dc + 1;
-                    cells.emplace_back(r, c);
+    // fixpoint: any clause reduced to a single unfixed literal fixes it
+    bool changed = true;
+    bool conflict = false;
+    while (changed && !conflict) {
+        changed = false;
+        for (const auto &cl : tmpl) {
+            int unfixed = 0;
+            int last = 0;
+            bool sat = false;
+            for (int lit : cl) {
+                int v = lit > 0 ? lit : -lit;
+                int sign = lit > 0 ? 1 : -1;
+                if (val[v] == 0) {
+                    ++unfixed;
+                    last = lit;
+                } else if (val[v] == sign) {
+                    sat = true;
+                    break;
                 }
             }
+            if (sat) continue;
+            if (unfixed == 0) {
+                conflict = true;
+                break;
+            }
+            if (unfixed == 1) {
+                val[last > 0 ? last : -last] = last > 0 ? 1 : -1;
+                changed = true;
+            }
+        }
+    }
 
-            for (int d = 1; d <= NUM_DIGITS; ++d) {
-                for (int i = 0; i < (int)cells.size(); ++i) {
-                    for (int j = i + 1; j < (int)cells.size(); ++j) {
-                        int r1 = cells[i].first;
-                        int c1 = cells[i].second;
-                        int r2 = cells[j].first;
-                        int c2 = cells[j].second;
-                        clauses.push_back({
-                            -varnum(r1, c1, d),
-                            -varnum(r2, c2, d)
-                        });
-                    }
-                }
+    out.clear();
+    if (conflict) {
+        out.end_clause(); // empty clause: trivially UNSAT
+        return false;
+    }
+
+    // surviving structural clauses, with falsified literals stripped
+    for (const auto &cl : tmpl) {
+        bool sat = false;
+        for (int lit : cl) {
+            int v = lit > 0 ? lit : -lit;
+            if (val[v] == (lit > 0 ? 1 : -1)) {
+                sat = true;
+                break;
+            }
+        }
+        if (sat) continue;
+        for (int lit : cl) {
+            int v = lit > 0 ? lit : -lit;
+            if (val[v] == 0) {
+                out.push_literal(lit);
             }
         }
+        out.end_clause();
+    }
+
+    // unit clauses for everything propagation fixed
+    for (int v = 1; v <= total_vars; ++v) {
+        if (val[v] != 0) {
+            out.add({ val[v] > 0 ? v : -v });
+        }
+    }
+    return true;
+}
+
+// build the full minimal encoding for one grid and dump it as DIMACS
+// through the buffered writer, finishing with a single write() to fd
+bool encode_and_emit(const int grid[9][9], int fd) {
+    static sudsat::DimacsWriter writer;
+
+    if (opt_propagate) {
+        // reduced formula: givens applied, satisfied clauses dropped
+        static sudsat::ClauseStore reduced;
+        {
+            auto t = timings.scope("encode");
+            build_propagated(grid, reduced);
+        }
+        auto t = timings.scope("emit");
+        writer.header(total_vars, reduced.size());
+        for (const auto &cl : reduced) {
+            writer.clause(cl);
+        }
+    } else {
+        // the structural clauses come from the shared template; only
+        // the unit clauses for the clues are built per puzzle
+        const sudsat::ClauseStore &tmpl = structural_clauses();
+        {
+            auto t = timings.scope("encode");
+            add_givens(grid);
+        }
+        auto t = timings.scope("emit");
+        writer.header(total_vars, tmpl.size() + givens.size());
+        for (const auto &cl : tmpl) {
+            writer.clause(cl);
+        }
+        for (const auto &cl : givens) {
+            writer.clause(cl);
+        }
     }
+
+    auto t = timings.scope("write");
+    if (!writer.flush_to_fd(fd)) {
+        cerr << "Error: write failed while emitting CNF\n";
+        return false;
+    }
+    return true;
 }
 
-// add the givens to the clauses
-void add_givens(const int grid[9][9]) {
-    // Unit clauses for clues.
+// emit the same encoding in the compact binary CNF format (see
+// cnf_binary.hpp) so the solver stage can mmap it instead of parsing
+// ~9,600 clauses of DIMACS text
+bool encode_and_emit_binary(const int grid[9][9], int fd) {
+    if (opt_propagate) {
+        static sudsat::ClauseStore reduced;
+        static const sudsat::ClauseStore empty;
+        build_propagated(grid, reduced);
+        if (!sudsat::write_cnf_binary(fd, total_vars, reduced, empty)) {
+            cerr << "Error: write failed while emitting binary CNF\n";
+            return false;
+        }
+        return true;
+    }
+
+    const sudsat::ClauseStore &tmpl = structural_clauses();
+    add_givens(grid);
+
+    if (!sudsat::write_cnf_binary(fd, total_vars, tmpl, givens)) {
+        cerr << "Error: write failed while emitting binary CNF\n";
+        return false;
+    }
+    return true;
+}
+
+// load a binary CNF (mmap, no text parse) and solve it in-process
+bool solve_binary(const string &path, ostream &out) {
+    sudsat::BinaryCnf cnf;
+    {
+        auto t = timings.scope("load");
+        if (!cnf.open(path)) {
+            cerr << "Error: cannot load binary CNF " << path << "\n";
+            return false;
+        }
+    }
+
+    sudsat::Solver solver(cnf.num_vars());
+    {
+        auto t = timings.scope("solve");
+        for (int i = 0; i < cnf.num_clauses(); ++i) {
+            auto cl = cnf.clause(i);
+            if (!solver.add_clause(cl.begin(), cl.size())) {
+                cerr << "UNSAT: puzzle has no solution.\n";
+                return false;
+            }
+        }
+
+        if (!solver.solve()) {
+            cerr << "UNSAT: puzzle has no solution.\n";
+            return false;
+        }
+    }
+
+    auto t = timings.scope("decode");
     for (int r = 1; r <= NUM_ROWS; ++r) {
         for (int c = 1; c <= NUM_COLS; ++c) {
-            int d = grid[r-1][c-1];
-            if (1 <= d && d <= 9) {
-                clauses.push_back({ varnum(r, c, d) });
+            for (int d = 1; d <= NUM_DIGITS; ++d) {
+                if (solver.model(varnum(r, c, d)) == 1) {
+                    out << d;
+                    break;
+                }
             }
         }
+        out << "\n";
     }
+    return true;
 }
 
-bool read_grid(istream &in, int grid[9][9]) {
-    string all;
-    string line;
+// build the clauses for one grid and solve them in-process with the
+// embedded CDCL engine; prints the solved grid (9 lines of 9 digits)
+// like sat2sud, without any DIMACS round-trip
+bool encode_and_solve(const int grid[9][9], ostream &out) {
+    const sudsat::ClauseStore &tmpl = structural_clauses();
+    {
+        auto t = timings.scope("encode");
+        add_givens(grid);
+    }
 
-    // Read all lines and strip whitespace globally
-    while (getline(in, line)) {
-        for (unsigned char ch : line) {
-            if (!isspace(ch)) {
-                all.push_back(ch);
+    sudsat::Solver solver(total_vars);
+    {
+        auto t = timings.scope("solve");
+        for (const auto &cl : tmpl) {
+            solver.add_clause(cl.begin(), cl.size());
+        }
+        for (const auto &cl : givens) {
+            if (!solver.add_clause(cl.begin(), cl.size())) {
+                cerr << "UNSAT: puzzle has no solution.\n";
+                return false;
             }
         }
+
+        if (!solver.solve()) {
+            cerr << "UNSAT: puzzle has no solution.\n";
+            return false;
+        }
     }
 
-    if ((int)all.size() != 81) {
-        cerr << "Error: expected exactly 81 non-whitespace characters, got "
-             << all.size() << "\n";
-        return false;
+    // decode the model: the true variable per cell names its digit
+    auto t = timings.scope("decode");
+    for (int r = 1; r <= NUM_ROWS; ++r) {
+        for (int c = 1; c <= NUM_COLS; ++c) {
+            for (int d = 1; d <= NUM_DIGITS; ++d) {
+                if (solver.model(varnum(r, c, d)) == 1) {
+                    out << d;
+                    break;
+                }
+            }
+        }
+        out << "\n";
     }
+    return true;
+}
 
-    // Map each of the 81 chars into grid[row][col]
-    for (int k = 0; k < 81; ++k) {
-        char ch = all[k];
-        int r = k / 9;
-        int c = k % 9;
+// batch mode: one puzzle per line (top95 style), one CNF per puzzle.
+// The dataset is mmap'd and scanned in place; each puzzle is an 81-byte
+// view straight out of the mapping. If outdir is empty the CNFs are
+// concatenated on stdout; otherwise each puzzle k is written to
+// <outdir>/<k>.cnf.
+int run_batch(const string &batchfile, const string &outdir, bool solve,
+              bool binary) {
+    sudsat::PuzzleSource src;
+    if (!src.open(batchfile)) {
+        cerr << "Error: cannot open batch file " << batchfile << "\n";
+        return 1;
+    }
 
-        if (ch >= '1' && ch <= '9') {
-            grid[r][c] = ch - '0';
-        } else if (ch == '0' || ch == '.' || ch == '*' || ch == '?') {
-            grid[r][c] = 0; // wildcard = empty
+    int index = 0;
+    int grid[9][9];
+    const char *puzzle;
+    while ((puzzle = src.next()) != nullptr) {
+        bool grid_ok;
+        {
+            auto t = timings.scope("parse");
+            grid_ok = fill_grid81(puzzle, grid);
+        }
+        if (!grid_ok) {
+            cerr << "Error: bad puzzle on line " << src.line()
+                 << " of " << batchfile << "\n";
+            return 1;
+        }
+        if (!sudsat::givens_consistent(grid)) {
+            cerr << "Error: conflicting givens in puzzle on line "
+                 << src.line() << " of " << batchfile << "\n";
+            return 1;
+        }
+
+        if (solve) {
+            if (!encode_and_solve(grid, cout)) {
+                cerr << "Error: puzzle on line " << src.line()
+                     << " of " << batchfile << " is unsolvable\n";
+                return 1;
+            }
+        } else if (outdir.empty()) {
+            bool ok = binary ? encode_and_emit_binary(grid, STDOUT_FILENO)
+                             : encode_and_emit(grid, STDOUT_FILENO);
+            if (!ok) {
+                return 1;
+            }
         } else {
-            // treat as error
-            cerr << "Error: invalid character '" << ch
-                 << "' at position " << k << "\n";
-            return false;
+            ostringstream path;
+            path << outdir << "/" << index << (binary ? ".scnf" : ".cnf");
+            int fd = open(path.str().c_str(),
+                          O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) {
+                cerr << "Error: cannot write " << path.str() << "\n";
+                return 1;
+            }
+            bool ok = binary ? encode_and_emit_binary(grid, fd)
+                             : encode_and_emit(grid, fd);
+            close(fd);
+            if (!ok) {
+                return 1;
+            }
         }
+        ++index;
     }
 
-    return true;
-}
+    if (src.bad_line() != 0) {
+        cerr << "Error: malformed puzzle on line " << src.bad_line()
+             << " of " << batchfile << "\n";
+        return 1;
+    }
 
+    return 0;
+}
 
 int main(int argc, char *argv[]) {
     string filename;
+    string batchfile;
+    string outdir;
+    string binfile;
+    bool solve = false;
+    bool binary = false;
 
-    // Usage: sud2sat [puzzlefile]
+    // Usage: sud2sat [--solve] [--binary] [--propagate] [puzzlefile]
+    //        sud2sat [options] --batch file [--outdir dir]
+    //        sud2sat --solve-binary file.scnf
     // If puzzlefile is omitted, read from STDIN.
-    if (argc >= 2) {
-        filename = argv[1];
+    // --solve runs the embedded SAT solver and prints the solved grid
+    // instead of emitting DIMACS; --binary emits the compact binary CNF
+    // format instead of DIMACS text; --propagate applies the givens by
+    // unit propagation at encode time and emits the reduced CNF;
+    // --amo pairwise|sequential|commander picks the at-most-one
+    // strategy for the structural constraints; --timing dumps
+    // per-stage wall times on stderr as one key=value line.
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--batch" && i + 1 < argc) {
+            batchfile = argv[++i];
+        } else if (arg == "--outdir" && i + 1 < argc) {
+            outdir = argv[++i];
+        } else if (arg == "--solve") {
+            solve = true;
+        } else if (arg == "--binary") {
+            binary = true;
+        } else if (arg == "--propagate") {
+            opt_propagate = true;
+        } else if (arg == "--timing") {
+            timings.enabled = true;
+        } else if (arg == "--amo" && i + 1 < argc) {
+            string kind = argv[++i];
+            if (kind == "sequential") {
+                opt_amo = sudsat::Encoding9::AMO_SEQUENTIAL;
+            } else if (kind == "commander") {
+                opt_amo = sudsat::Encoding9::AMO_COMMANDER;
+            } else if (kind != "pairwise") {
+                cerr << "Error: unknown --amo strategy " << kind
+                     << " (pairwise, sequential, commander)\n";
+                return 1;
+            }
+        } else if (arg == "--solve-binary" && i + 1 < argc) {
+            binfile = argv[++i];
+        } else {
+            filename = arg;
+        }
+    }
+
+    if (!binfile.empty()) {
+        int rc = solve_binary(binfile, cout) ? 0 : 1;
+        timings.report(cerr);
+        return rc;
+    }
+
+    if (!batchfile.empty()) {
+        int rc = run_batch(batchfile, outdir, solve, binary);
+        timings.report(cerr);
+        return rc;
     }
 
     istream *in = &cin;
@@ -182,32 +501,32 @@ int main(int argc, char *argv[]) {
     }
 
     int grid[9][9];
-    if (!read_grid(*in, grid)) {
+    bool grid_ok;
+    {
+        auto t = timings.scope("parse");
+        grid_ok = read_grid(*in, grid);
+    }
+    if (!grid_ok) {
         // read_grid already prints a clear message
         return 1;
     }
 
-    // --- Build minimal encoding clauses ---
-    clauses.clear();
-    add_cell_at_least_one();
-    add_row_at_most_one();
-    add_col_at_most_one();
-    add_box_at_most_one();
-
-    // Add givens (unit clauses for clues)
-    add_givens(grid);
-
-    // --- Output DIMACS CNF ---
-    int numClauses = (int)clauses.size();
-    cout << "p cnf " << NUM_VARS << " " << numClauses << "\n";
-
-    for (const auto &cl : clauses) {
-        for (int lit : cl) {
-            cout << lit << " ";
-        }
-        cout << "0\n";
+    // reject contradictory clues before building a single clause
+    if (!sudsat::givens_consistent(grid)) {
+        cerr << "Error: conflicting givens (duplicate digit in a row,"
+                " column, or box)\n";
+        return 1;
     }
 
-    return 0;
+    int rc;
+    if (solve) {
+        rc = encode_and_solve(grid, cout) ? 0 : 1;
+    } else if (binary) {
+        rc = encode_and_emit_binary(grid, STDOUT_FILENO) ? 0 : 1;
+    } else {
+        rc = encode_and_emit(grid, STDOUT_FILENO) ? 0 : 1;
+    }
+    timings.report(cerr);
+    return rc;
 }
 
@@ -0,0 +1,967 @@
+// sudoku_batch.cpp
+//
+// Native multithreaded batch driver: loads a dataset (one puzzle per
+// line, top95 style), distributes puzzles across a thread pool with
+// work stealing, and runs the encode -> solve -> decode chain in-process
+// per worker using the embedded CDCL solver. Solutions are printed in
+// input order, 9 lines of 9 digits per puzzle.
+//
+// Usage: sudoku_batch [--threads N] puzzlefile
+//
+// For datasets beyond one machine, --shard I/N processes only the I-th
+// of N byte-range chunks of the file (aligned on puzzle boundaries by
+// PuzzleSource), so the nightly job can fan one file out to N
+// independent processes: run shard i with --out prefix.i, then stitch
+// the per-shard files back in stable order with --merge prefix N.
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <cctype>
+#include <cstring>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <chrono>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "clause_store.hpp"
+#include "cnf_binary.hpp"
+#include "cnf_simplify.hpp"
+#include "propagation.hpp"
+#include "puzzle_source.hpp"
+#include "sudoku_encoding.hpp"
+#include "solver/solver.hpp"
+#include "solver_stats.hpp"
+
+using namespace std;
+
+typedef sudsat::Encoding9 Enc;
+
+static const int NUM_ROWS = 9;
+static const int NUM_COLS = 9;
+static const int NUM_DIGITS = 9;
+static const int NUM_VARS = Enc::NUM_VARS; // 729
+
+int varnum(int r, int c, int d) {
+    return Enc::varnum(r, c, d);
+}
+
+// the shared read-only structural templates; built once in main before
+// the workers start. `structural` is the minimal encoding; `extended`
+// additionally carries the redundant constraint set of sud2sat1.
+sudsat::ClauseStore structural;
+sudsat::ClauseStore extended;
+
+// encoding choice per run: fixed minimal (default), fixed extended,
+// routed per puzzle by a difficulty heuristic (--route auto), or a
+// two-thread race between both encodings (--route portfolio)
+enum RouteMode { ROUTE_MINIMAL, ROUTE_EXTENDED, ROUTE_AUTO,
+                 ROUTE_PORTFOLIO };
+RouteMode route_mode = ROUTE_MINIMAL;
+
+// --no-presolve: skip the propagation fast path (useful for isolating
+// the SAT pipeline in measurements)
+bool opt_presolve = true;
+
+// --pipeline: overlapped encode/solve/decode stages instead of the
+// per-worker sequential chain (one-shot solving; routes minimal,
+// extended, and auto)
+bool opt_pipeline = false;
+
+// optional structured stats sink (--stats file.csv|file.jsonl)
+sudsat::StatsSink *stats_sink = nullptr;
+
+// --incremental: one solver per worker, givens passed as assumptions
+bool opt_incremental = false;
+
+// --learnts-in: warm-start file of structural lemmas (binary CNF),
+// preloaded into every solver after the template. Such clauses are
+// implied by the structural CNF alone — they come from assumption-
+// based solves, where givens never enter the clause database — so
+// they are sound for any puzzle sharing the encoding.
+sudsat::BinaryCnf warm_start;
+bool have_warm = false;
+
+// --learnts-out: collects each worker's learnt clauses after an
+// --incremental batch and writes them as a warm-start file
+sudsat::ClauseStore exported_learnts;
+mutex exported_mtx;
+bool opt_learnts_out = false;
+
+// --sink: positional output file of fixed-width 90-byte records (9
+// rows of 9 digits, newline-framed — the same shape as the streamed
+// output) with puzzle i's record pwritten at offset i * 90. Workers
+// land their slots lock-free and out of order; the file reads back in
+// input order as one sequential pass. UNSAT and malformed puzzles
+// leave a recognizable all-dots record so the slot grid stays fixed.
+int sink_fd = -1;
+static const int SINK_RECORD = 90;
+
+void sink_write(int idx, const string &sol, atomic<int> &failures) {
+    char rec[SINK_RECORD];
+    if ((int)sol.size() == SINK_RECORD) {
+        memcpy(rec, sol.data(), SINK_RECORD);
+    } else {
+        for (int r = 0; r < 9; ++r) {
+            memset(rec + r * 10, '.', 9);
+            rec[r * 10 + 9] = '\n';
+        }
+    }
+    size_t done = 0;
+    while (done < sizeof(rec)) {
+        ssize_t n = pwrite(sink_fd, rec + done, sizeof(rec) - done,
+                           (off_t)idx * SINK_RECORD + (off_t)done);
+        if (n <= 0) {
+            cerr << "Error: sink write failed for puzzle "
+                 << (idx + 1) << "\n";
+            ++failures;
+            return;
+        }
+        done += (size_t)n;
+    }
+}
+
+void load_warm(sudsat::Solver &solver) {
+    if (!have_warm) {
+        return;
+    }
+    for (int i = 0; i < warm_start.num_clauses(); ++i) {
+        auto cl = warm_start.clause(i);
+        solver.add_clause(cl.begin(), cl.size());
+    }
+}
+
+// per-worker solver state. In one-shot mode a fresh solver is built
+// per puzzle; in incremental mode the worker's solver is loaded with
+// the structural clauses once and each puzzle's givens are passed as
+// assumptions, keeping the clause database (and everything learnt)
+// across the whole batch.
+struct WorkerSolver {
+    sudsat::Solver *incr = nullptr;
+    long long prev_conflicts = 0;
+    long long prev_decisions = 0;
+    long long prev_propagations = 0;
+
+    ~WorkerSolver() { delete incr; }
+
+    sudsat::Solver &get(bool use_extended) {
+        const sudsat::ClauseStore &tmpl = use_extended ? extended
+                                                       : structural;
+        if (opt_incremental) {
+            if (!incr) {
+                incr = new sudsat::Solver(NUM_VARS);
+                for (const auto &cl : tmpl) {
+                    incr->add_clause(cl.begin(), cl.size());
+                }
+                load_warm(*incr);
+            }
+            return *incr;
+        }
+        delete incr;
+        incr = new sudsat::Solver(NUM_VARS);
+        for (const auto &cl : tmpl) {
+            incr->add_clause(cl.begin(), cl.size());
+        }
+        load_warm(*incr);
+        // fresh solver, fresh counters
+        prev_conflicts = prev_decisions = prev_propagations = 0;
+        return *incr;
+    }
+};
+
+string format_grid(const int grid[9][9]) {
+    string out;
+    out.reserve(90);
+    for (int r = 0; r < 9; ++r) {
+        for (int c = 0; c < 9; ++c) {
+            out.push_back((char)('0' + grid[r][c]));
+        }
+        out.push_back('\n');
+    }
+    return out;
+}
+
+// portfolio race: one thread per encoding, first finisher wins and
+// cancels the other via the solver's interrupt flag. Neither encoding
+// dominates on hard puzzles (per-puzzle variance between sud2sat and
+// sud2sat1 is wide), so the race bounds the tail by the better of the
+// two at the cost of one extra core while it runs.
+string solve_portfolio(const int grid[9][9], int puzzle_no,
+                       chrono::steady_clock::time_point t0) {
+    atomic<bool> stop(false);
+    atomic<int> winner(-1);
+    string result;
+    bool sat = false;
+    long long conflicts = 0, decisions = 0, propagations = 0;
+
+    auto race = [&](int side) {
+        const sudsat::ClauseStore &tmpl = side ? extended : structural;
+        sudsat::Solver solver(NUM_VARS);
+        solver.set_interrupt(&stop);
+        bool ok = true;
+        for (const auto &cl : tmpl) {
+            solver.add_clause(cl.begin(), cl.size());
+        }
+        load_warm(solver);
+        for (int r = 1; r <= NUM_ROWS && ok; ++r) {
+            for (int c = 1; c <= NUM_COLS && ok; ++c) {
+                int d = grid[r - 1][c - 1];
+                if (d != 0) {
+                    int lit = varnum(r, c, d);
+                    ok = solver.add_clause(&lit, 1);
+                }
+            }
+        }
+        bool s = ok && solver.solve();
+        if (solver.interrupted()) {
+            return; // lost the race
+        }
+        int expect = -1;
+        if (!winner.compare_exchange_strong(expect, side)) {
+            return; // the other side finished first
+        }
+        stop.store(true);
+        sat = s;
+        conflicts = solver.conflicts();
+        decisions = solver.decisions();
+        propagations = solver.propagations();
+        if (s) {
+            result.reserve(90);
+            for (int r = 1; r <= NUM_ROWS; ++r) {
+                for (int c = 1; c <= NUM_COLS; ++c) {
+                    for (int d = 1; d <= NUM_DIGITS; ++d) {
+                        if (solver.model(varnum(r, c, d)) == 1) {
+                            result.push_back((char)('0' + d));
+                            break;
+                        }
+                    }
+                }
+                result.push_back('\n');
+            }
+        }
+    };
+
+    thread t_min(race, 0), t_ext(race, 1);
+    t_min.join();
+    t_ext.join();
+
+    if (stats_sink) {
+        sudsat::SolveStats st;
+        st.puzzle = puzzle_no;
+        st.sat = sat;
+        st.conflicts = conflicts;
+        st.decisions = decisions;
+        st.propagations = propagations;
+        st.solve_ns = chrono::duration_cast<chrono::nanoseconds>(
+                          chrono::steady_clock::now() - t0).count();
+        stats_sink->add(st);
+    }
+    return sat ? result : "";
+}
+
+// encode one grid against the shared template and solve it in-process;
+// returns the 9-line solution text, or "" on UNSAT. `cand` holds the
+// candidate masks from the one-pass parse and is consumed by the
+// pre-solver.
+string solve_one(const int grid[9][9], int cand[9][9], int puzzle_no,
+                 WorkerSolver &ws) {
+    auto t0 = chrono::steady_clock::now();
+
+    // propagation pre-solver: p096-class puzzles fall here without ever
+    // touching the SAT machinery, and for the rest the forced cells
+    // become extra givens. The fixpoint also feeds the --route auto
+    // heuristic: many open cells means top95-class, worth the extended
+    // encoding's stronger propagation.
+    int forced[9][9];
+    sudsat::PropagationResult pr;
+    pr.open_cells = 81;
+    if (opt_presolve || route_mode == ROUTE_AUTO) {
+        pr = sudsat::propagate_cand(cand, forced);
+    }
+    if (opt_presolve && (pr.solved || pr.contradiction)) {
+        if (stats_sink) {
+            sudsat::SolveStats st;
+            st.puzzle = puzzle_no;
+            st.sat = !pr.contradiction;
+            st.conflicts = st.decisions = st.propagations = 0;
+            st.solve_ns = chrono::duration_cast<chrono::nanoseconds>(
+                              chrono::steady_clock::now() - t0).count();
+            stats_sink->add(st);
+        }
+        return pr.contradiction ? "" : format_grid(forced);
+    }
+    const int (*givens)[9] = opt_presolve ? forced : grid;
+
+    // portfolio: race both encodings; incremental workers keep one
+    // persistent solver, so the race only applies to one-shot mode
+    if (route_mode == ROUTE_PORTFOLIO && !opt_incremental) {
+        return solve_portfolio(givens, puzzle_no, t0);
+    }
+
+    // route: fixed choice, or per-puzzle heuristic. Incremental workers
+    // keep one solver, so routing is pinned to the fixed choice there.
+    bool use_extended = route_mode == ROUTE_EXTENDED;
+    if (route_mode == ROUTE_AUTO && !opt_incremental) {
+        use_extended = pr.open_cells > 10;
+    }
+
+    sudsat::Solver &solver = ws.get(use_extended);
+
+    bool sat;
+    if (opt_incremental) {
+        vector<int> assumptions;
+        assumptions.reserve(81);
+        for (int r = 1; r <= NUM_ROWS; ++r) {
+            for (int c = 1; c <= NUM_COLS; ++c) {
+                int d = givens[r - 1][c - 1];
+                if (d != 0) {
+                    assumptions.push_back(varnum(r, c, d));
+                }
+            }
+        }
+        sat = solver.solve(assumptions);
+    } else {
+        bool ok = true;
+        for (int r = 1; r <= NUM_ROWS && ok; ++r) {
+            for (int c = 1; c <= NUM_COLS && ok; ++c) {
+                int d = givens[r - 1][c - 1];
+                if (d != 0) {
+                    int lit = varnum(r, c, d);
+                    ok = solver.add_clause(&lit, 1);
+                }
+            }
+        }
+        sat = ok && solver.solve();
+    }
+
+    if (stats_sink) {
+        sudsat::SolveStats st;
+        st.puzzle = puzzle_no;
+        st.sat = sat;
+        // the incremental solver's counters run across puzzles;
+        // report the per-puzzle delta
+        st.conflicts = solver.conflicts() - ws.prev_conflicts;
+        st.decisions = solver.decisions() - ws.prev_decisions;
+        st.propagations = solver.propagations() - ws.prev_propagations;
+        st.solve_ns = chrono::duration_cast<chrono::nanoseconds>(
+                          chrono::steady_clock::now() - t0).count();
+        stats_sink->add(st);
+    }
+    ws.prev_conflicts = solver.conflicts();
+    ws.prev_decisions = solver.decisions();
+    ws.prev_propagations = solver.propagations();
+
+    if (!sat) {
+        return "";
+    }
+
+    string out;
+    out.reserve(90);
+    for (int r = 1; r <= NUM_ROWS; ++r) {
+        for (int c = 1; c <= NUM_COLS; ++c) {
+            for (int d = 1; d <= NUM_DIGITS; ++d) {
+                if (solver.model(varnum(r, c, d)) == 1) {
+                    out.push_back((char)('0' + d));
+                    break;
+                }
+            }
+        }
+        out.push_back('\n');
+    }
+    return out;
+}
+
+// --- pipelined mode: overlapped encode / solve / decode stages ---
+//
+// --pipeline runs the three stages on their own threads, joined by
+// double-buffered rings: while the solver works on puzzle N, the
+// encode stage parses and pre-solves N+1 and the decode stage formats
+// N-1's model. Encode and decode cost microseconds against the
+// solver's milliseconds, so the overlap hides them entirely; the small
+// capacity keeps at most a couple of jobs in flight per stage.
+
+template <typename T>
+class Ring {
+public:
+    void push(T v) {
+        unique_lock<mutex> lock(mtx_);
+        room_.wait(lock, [&] { return items_.size() < 2; });
+        items_.push_back(move(v));
+        avail_.notify_one();
+    }
+
+    // returns false once the ring is closed and drained
+    bool pop(T &v) {
+        unique_lock<mutex> lock(mtx_);
+        avail_.wait(lock, [&] { return !items_.empty() || closed_; });
+        if (items_.empty()) {
+            return false;
+        }
+        v = move(items_.front());
+        items_.pop_front();
+        room_.notify_one();
+        return true;
+    }
+
+    void close() {
+        lock_guard<mutex> lock(mtx_);
+        closed_ = true;
+        avail_.notify_all();
+    }
+
+private:
+    deque<T> items_;
+    mutex mtx_;
+    condition_variable avail_, room_;
+    bool closed_ = false;
+};
+
+struct PipeJob {
+    int idx = 0;
+    bool done = false;        // resolved before the solver stage
+    bool sat = false;
+    bool use_extended = false;
+    string solution;          // fast-path result, or decode output
+    vector<int> units;        // givens after the pre-solver
+    vector<int> model;        // model digits by variable, solve output
+    long long presolve_ns = 0;
+};
+
+int run_pipeline(const vector<const char *> &puzzles,
+                 vector<string> &solutions, atomic<int> &failures) {
+    Ring<PipeJob> to_solve;
+    Ring<PipeJob> to_decode;
+
+    // stage 1: parse, pre-solve, and build the givens
+    thread encoder([&] {
+        int grid[9][9], cand[9][9], forced[9][9];
+        for (int idx = 0; idx < (int)puzzles.size(); ++idx) {
+            PipeJob job;
+            job.idx = idx;
+            auto t0 = chrono::steady_clock::now();
+            if (!sudsat::parse_grid81_masks(puzzles[idx], grid, cand)) {
+                cerr << "Error: bad puzzle on line " << (idx + 1) << "\n";
+                ++failures;
+                if (sink_fd >= 0) {
+                    sink_write(idx, string(), failures);
+                }
+                continue;
+            }
+            sudsat::PropagationResult pr;
+            pr.open_cells = 81;
+            const int (*givens)[9] = grid;
+            if (opt_presolve || route_mode == ROUTE_AUTO) {
+                pr = sudsat::propagate_cand(cand, forced);
+                if (opt_presolve) {
+                    givens = forced;
+                }
+            }
+            if (opt_presolve && (pr.solved || pr.contradiction)) {
+                job.done = true;
+                job.sat = !pr.contradiction;
+                if (job.sat) {
+                    job.solution = format_grid(forced);
+                }
+            } else {
+                job.use_extended =
+                    route_mode == ROUTE_EXTENDED
+                    || (route_mode == ROUTE_AUTO && pr.open_cells > 10);
+                job.units.reserve(81);
+                for (int r = 1; r <= NUM_ROWS; ++r) {
+                    for (int c = 1; c <= NUM_COLS; ++c) {
+                        int d = givens[r - 1][c - 1];
+                        if (d != 0) {
+                            job.units.push_back(varnum(r, c, d));
+                        }
+                    }
+                }
+            }
+            job.presolve_ns = chrono::duration_cast<chrono::nanoseconds>(
+                                  chrono::steady_clock::now() - t0).count();
+            to_solve.push(move(job));
+        }
+        to_solve.close();
+    });
+
+    // stage 2: the solver proper
+    thread solver_stage([&] {
+        PipeJob job;
+        while (to_solve.pop(job)) {
+            if (!job.done) {
+                auto t0 = chrono::steady_clock::now();
+                const sudsat::ClauseStore &tmpl =
+                    job.use_extended ? extended : structural;
+                sudsat::Solver solver(NUM_VARS);
+                for (const auto &cl : tmpl) {
+                    solver.add_clause(cl.begin(), cl.size());
+                }
+                load_warm(solver);
+                bool ok = true;
+                for (size_t k = 0; k < job.units.size() && ok; ++k) {
+                    int lit = job.units[k];
+                    ok = solver.add_clause(&lit, 1);
+                }
+                job.sat = ok && solver.solve();
+                if (job.sat) {
+                    job.model.assign(NUM_VARS + 1, 0);
+                    for (int v = 1; v <= NUM_VARS; ++v) {
+                        job.model[v] = solver.model(v);
+                    }
+                }
+                if (stats_sink) {
+                    sudsat::SolveStats st;
+                    st.puzzle = job.idx + 1;
+                    st.sat = job.sat;
+                    st.conflicts = solver.conflicts();
+                    st.decisions = solver.decisions();
+                    st.propagations = solver.propagations();
+                    st.solve_ns =
+                        job.presolve_ns
+                        + chrono::duration_cast<chrono::nanoseconds>(
+                              chrono::steady_clock::now() - t0).count();
+                    stats_sink->add(st);
+                }
+            } else if (stats_sink) {
+                sudsat::SolveStats st;
+                st.puzzle = job.idx + 1;
+                st.sat = job.sat;
+                st.conflicts = st.decisions = st.propagations = 0;
+                st.solve_ns = job.presolve_ns;
+                stats_sink->add(st);
+            }
+            to_decode.push(move(job));
+        }
+        to_decode.close();
+    });
+
+    // stage 3: model to 9-line text
+    thread decoder([&] {
+        PipeJob job;
+        while (to_decode.pop(job)) {
+            if (!job.done && job.sat) {
+                job.solution.reserve(90);
+                for (int r = 1; r <= NUM_ROWS; ++r) {
+                    for (int c = 1; c <= NUM_COLS; ++c) {
+                        for (int d = 1; d <= NUM_DIGITS; ++d) {
+                            if (job.model[varnum(r, c, d)] == 1) {
+                                job.solution.push_back((char)('0' + d));
+                                break;
+                            }
+                        }
+                    }
+                    job.solution.push_back('\n');
+                }
+            }
+            if (!job.sat) {
+                cerr << "UNSAT: puzzle on line " << (job.idx + 1)
+                     << " has no solution\n";
+                ++failures;
+            }
+            if (sink_fd >= 0) {
+                sink_write(job.idx, job.solution, failures);
+            } else {
+                solutions[job.idx] = move(job.solution);
+            }
+        }
+    });
+
+    encoder.join();
+    solver_stage.join();
+    decoder.join();
+    return 0;
+}
+
+// --- work-stealing thread pool ---
+//
+// Each worker owns a deque of puzzle indices and pops from its front;
+// when it runs dry it steals from the back of another worker's deque.
+// Hard puzzles (top95-class) take wildly variable time, so static
+// partitioning alone would leave workers idle at the tail.
+
+struct WorkerQueue {
+    deque<int> items;
+    mutex mtx;
+};
+
+struct Pool {
+    vector<WorkerQueue> queues;
+    explicit Pool(int n) : queues(n) {}
+
+    bool pop_local(int w, int &idx) {
+        WorkerQueue &q = queues[w];
+        lock_guard<mutex> lock(q.mtx);
+        if (q.items.empty()) return false;
+        idx = q.items.front();
+        q.items.pop_front();
+        return true;
+    }
+
+    bool steal(int w, int &idx) {
+        int n = (int)queues.size();
+        for (int k = 1; k < n; ++k) {
+            WorkerQueue &q = queues[(w + k) % n];
+            lock_guard<mutex> lock(q.mtx);
+            if (!q.items.empty()) {
+                idx = q.items.back();
+                q.items.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// --merge: stitch per-shard solution files (prefix.0 .. prefix.N-1)
+// back together in shard order. Each shard preserved its own input
+// order, so the concatenation reproduces the dataset order exactly.
+int merge_shards(const string &prefix, int nshards, ostream &out) {
+    for (int i = 0; i < nshards; ++i) {
+        ostringstream path;
+        path << prefix << "." << i;
+        ifstream in(path.str().c_str(), ios::binary);
+        if (!in) {
+            cerr << "Error: cannot open shard file " << path.str() << "\n";
+            return 1;
+        }
+        out << in.rdbuf();
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    string filename;
+    string statsfile;
+    string outfile;
+    string sinkfile;
+    string learnts_in;
+    string learnts_out;
+    string merge_prefix;
+    int merge_n = 0;
+    int shard = 0, nshards = 1;
+    int num_threads = (int)thread::hardware_concurrency();
+    if (num_threads < 1) num_threads = 1;
+    bool threads_set = false;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+            if (num_threads < 1) num_threads = 1;
+            threads_set = true;
+        } else if (arg == "--stats" && i + 1 < argc) {
+            statsfile = argv[++i];
+        } else if (arg == "--shard" && i + 1 < argc) {
+            if (sscanf(argv[++i], "%d/%d", &shard, &nshards) != 2
+                || nshards < 1 || shard < 0 || shard >= nshards) {
+                cerr << "Error: --shard wants I/N with 0 <= I < N\n";
+                return 1;
+            }
+        } else if (arg == "--out" && i + 1 < argc) {
+            outfile = argv[++i];
+        } else if (arg == "--sink" && i + 1 < argc) {
+            sinkfile = argv[++i];
+        } else if (arg == "--learnts-in" && i + 1 < argc) {
+            learnts_in = argv[++i];
+        } else if (arg == "--learnts-out" && i + 1 < argc) {
+            learnts_out = argv[++i];
+        } else if (arg == "--merge" && i + 2 < argc) {
+            merge_prefix = argv[++i];
+            merge_n = atoi(argv[++i]);
+            if (merge_n < 1) {
+                cerr << "Error: --merge wants a prefix and a shard count\n";
+                return 1;
+            }
+        } else if (arg == "--incremental") {
+            opt_incremental = true;
+        } else if (arg == "--no-presolve") {
+            opt_presolve = false;
+        } else if (arg == "--pipeline") {
+            opt_pipeline = true;
+        } else if (arg == "--route" && i + 1 < argc) {
+            string mode = argv[++i];
+            if (mode == "minimal") {
+                route_mode = ROUTE_MINIMAL;
+            } else if (mode == "extended") {
+                route_mode = ROUTE_EXTENDED;
+            } else if (mode == "auto") {
+                route_mode = ROUTE_AUTO;
+            } else if (mode == "portfolio") {
+                route_mode = ROUTE_PORTFOLIO;
+            } else {
+                cerr << "Error: unknown --route mode " << mode
+                     << " (minimal, extended, auto, portfolio)\n";
+                return 1;
+            }
+        } else {
+            filename = arg;
+        }
+    }
+
+    // solutions go to stdout unless --out redirects them (the natural
+    // sink for per-shard runs)
+    ofstream fout;
+    ostream *out = &cout;
+    if (!outfile.empty()) {
+        fout.open(outfile.c_str(), ios::binary);
+        if (!fout) {
+            cerr << "Error: cannot write output file " << outfile << "\n";
+            return 1;
+        }
+        out = &fout;
+    }
+
+    if (!merge_prefix.empty()) {
+        return merge_shards(merge_prefix, merge_n, *out);
+    }
+
+    if (filename.empty()) {
+        cerr << "Usage: sudoku_batch [--threads N] [--incremental]"
+                " [--route minimal|extended|auto|portfolio]"
+                " [--no-presolve] [--pipeline] [--stats file]"
+                " [--shard I/N] [--out file] [--sink file]"
+                " [--learnts-in file] [--learnts-out file] puzzlefile\n"
+                "       sudoku_batch --merge prefix N [--out file]\n";
+        return 1;
+    }
+
+    // the pipeline runs its own fixed stage threads with one-shot
+    // solving; reject the combinations it would otherwise silently
+    // ignore or degrade
+    if (opt_pipeline && opt_incremental) {
+        cerr << "Error: --pipeline solves one-shot; it does not support"
+                " --incremental\n";
+        return 1;
+    }
+    if (opt_pipeline && route_mode == ROUTE_PORTFOLIO) {
+        cerr << "Error: --pipeline does not support --route portfolio"
+                " (use minimal, extended, or auto)\n";
+        return 1;
+    }
+    if (opt_pipeline && threads_set) {
+        cerr << "Error: --pipeline runs fixed stage threads;"
+                " --threads does not apply\n";
+        return 1;
+    }
+
+    // learnt clauses are sound across puzzles only when the givens
+    // enter as assumptions, never as clauses — so exporting requires
+    // incremental mode (one-shot solves mix puzzle units into the
+    // database and their learnts with them)
+    opt_learnts_out = !learnts_out.empty();
+    if (opt_learnts_out && (!opt_incremental || opt_pipeline)) {
+        cerr << "Error: --learnts-out requires --incremental"
+                " (and not --pipeline)\n";
+        return 1;
+    }
+    if (!learnts_in.empty()) {
+        if (!warm_start.open(learnts_in)) {
+            cerr << "Error: cannot open learnt-clause file "
+                 << learnts_in << "\n";
+            return 1;
+        }
+        if (warm_start.num_vars() > NUM_VARS) {
+            cerr << "Error: learnt-clause file " << learnts_in
+                 << " was written for " << warm_start.num_vars()
+                 << " variables, encoding has " << NUM_VARS << "\n";
+            return 1;
+        }
+        have_warm = true;
+    }
+
+    sudsat::StatsSink sink;
+    if (!statsfile.empty()) {
+        if (!sink.open(statsfile)) {
+            cerr << "Error: cannot write stats file " << statsfile << "\n";
+            return 1;
+        }
+        stats_sink = &sink;
+    }
+
+    // mmap the dataset and collect 81-byte views straight out of the
+    // mapping (kept alive by src for the whole run); only lines with
+    // embedded whitespace need an owned copy
+    sudsat::PuzzleSource src;
+    if (!src.open(filename, shard, nshards)) {
+        cerr << "Error: cannot open puzzle file " << filename << "\n";
+        return 1;
+    }
+
+    vector<const char *> puzzles;
+    deque<string> owned; // stable storage for compacted lines
+    const char *p;
+    while ((p = src.next()) != nullptr) {
+        if (src.is_scratch(p)) {
+            owned.push_back(string(p, 81));
+            puzzles.push_back(owned.back().c_str());
+        } else {
+            puzzles.push_back(p);
+        }
+    }
+    if (src.bad_line() != 0) {
+        cerr << "Error: malformed puzzle on line " << src.bad_line()
+             << " of " << filename << "\n";
+        return 1;
+    }
+
+    if (puzzles.empty()) {
+        if (nshards > 1) {
+            return 0; // a tiny shard can legitimately be empty
+        }
+        cerr << "Error: no puzzles in " << filename << "\n";
+        return 1;
+    }
+
+    if (num_threads > (int)puzzles.size()) {
+        num_threads = (int)puzzles.size();
+    }
+
+    // the sink is sized up front so out-of-order pwrites always land
+    // inside the file
+    if (!sinkfile.empty()) {
+        sink_fd = open(sinkfile.c_str(),
+                       O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (sink_fd < 0
+            || ftruncate(sink_fd,
+                         (off_t)puzzles.size() * SINK_RECORD) != 0) {
+            cerr << "Error: cannot create sink file " << sinkfile << "\n";
+            return 1;
+        }
+    }
+
+    // build the shared structural templates once, before the workers
+    Enc::add_structural(structural);
+    if (route_mode != ROUTE_MINIMAL) {
+        Enc::add_structural(extended);
+        Enc::add_extended(extended);
+    }
+
+    vector<string> solutions(puzzles.size());
+    atomic<int> failures(0);
+
+    if (opt_pipeline) {
+        run_pipeline(puzzles, solutions, failures);
+
+        // emit in input order (the sink already holds every record)
+        if (sink_fd >= 0) {
+            close(sink_fd);
+        } else {
+            for (const string &sol : solutions) {
+                if (!sol.empty()) {
+                    *out << sol;
+                }
+            }
+        }
+        if (stats_sink) {
+            sink.summarize(cerr);
+        }
+        return failures.load() == 0 ? 0 : 1;
+    }
+
+    // round-robin the puzzles over the worker queues
+    Pool pool(num_threads);
+    for (int i = 0; i < (int)puzzles.size(); ++i) {
+        pool.queues[i % num_threads].items.push_back(i);
+    }
+
+    auto worker = [&](int w) {
+        WorkerSolver ws;
+        int grid[9][9];
+        int cand[9][9];
+        int idx;
+        for (;;) {
+            if (!pool.pop_local(w, idx) && !pool.steal(w, idx)) {
+                break; // all queues drained
+            }
+            // one pass over the 81 bytes yields both the digit grid
+            // and the pre-solver's starting candidate masks
+            if (!sudsat::parse_grid81_masks(puzzles[idx], grid, cand)) {
+                cerr << "Error: bad puzzle on line " << (idx + 1) << "\n";
+                ++failures;
+                if (sink_fd >= 0) {
+                    sink_write(idx, string(), failures);
+                }
+                continue;
+            }
+            string sol = solve_one(grid, cand, idx + 1, ws);
+            if (sol.empty()) {
+                cerr << "UNSAT: puzzle on line " << (idx + 1)
+                     << " has no solution\n";
+                ++failures;
+            }
+            if (sink_fd >= 0) {
+                sink_write(idx, sol, failures);
+            } else {
+                solutions[idx] = move(sol);
+            }
+        }
+        if (opt_learnts_out && ws.incr) {
+            lock_guard<mutex> lock(exported_mtx);
+            ws.incr->export_learnts(exported_learnts);
+        }
+    };
+
+    vector<thread> threads;
+    for (int w = 0; w < num_threads; ++w) {
+        threads.emplace_back(worker, w);
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    if (opt_learnts_out) {
+        // keep only the short lemmas: loading and watching a long
+        // learnt clause in every subsequent solver costs more than its
+        // (weak) propagation saves, while the short ones carry nearly
+        // all of the conflict reduction
+        static const int LEARNT_EXPORT_MAX = 15;
+        sudsat::ClauseStore kept;
+        for (const auto &cl : exported_learnts) {
+            if (cl.size() <= LEARNT_EXPORT_MAX) {
+                for (int lit : cl) {
+                    kept.push_literal(lit);
+                }
+                kept.end_clause();
+            }
+        }
+        // workers learn the same structural lemmas independently;
+        // simplification collapses the duplicates before writing
+        sudsat::ClauseStore deduped;
+        sudsat::simplify_clauses(kept, NUM_VARS, deduped);
+        int fd = open(learnts_out.c_str(),
+                      O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        sudsat::ClauseStore empty;
+        if (fd < 0
+            || !sudsat::write_cnf_binary(fd, NUM_VARS, deduped, empty)) {
+            cerr << "Error: cannot write learnt-clause file "
+                 << learnts_out << "\n";
+            if (fd >= 0) close(fd);
+            return 1;
+        }
+        close(fd);
+    }
+
+    // emit in input order (the sink already holds every record)
+    if (sink_fd >= 0) {
+        close(sink_fd);
+    } else {
+        for (const string &sol : solutions) {
+            if (!sol.empty()) {
+                *out << sol;
+            }
+        }
+    }
+
+    if (stats_sink) {
+        sink.summarize(cerr);
+    }
+
+    return failures.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+// sudoku_bench.cpp
+//
+// In-process benchmark harness replacing the subprocess-based timings
+// of test_harness.py: drives the encoder, the embedded solver, and the
+// decoder directly, timing each stage with steady_clock at nanosecond
+// granularity. Runs warmup iterations first, then repeated measured
+// iterations, and reports min/median/p99 per puzzle plus aggregate
+// throughput — no process startup or tempfile noise in the numbers.
+//
+// Usage: sudoku_bench [--iters N] [--warmup N] [--extended] puzzlefile
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+
+#include "clause_store.hpp"
+#include "dimacs_writer.hpp"
+#include "sudoku_encoding.hpp"
+#include "puzzle_source.hpp"
+#include "solver/solver.hpp"
+
+using namespace std;
+
+typedef sudsat::Encoding9 Enc;
+
+static const int NUM_ROWS = 9;
+static const int NUM_COLS = 9;
+static const int NUM_DIGITS = 9;
+static const int NUM_VARS = Enc::NUM_VARS; // 729
+
+int varnum(int r, int c, int d) {
+    return Enc::varnum(r, c, d);
+}
+
+typedef chrono::steady_clock Clock;
+
+long long ns_since(Clock::time_point t0) {
+    return chrono::duration_cast<chrono::nanoseconds>(
+               Clock::now() - t0).count();
+}
+
+// order statistics over one puzzle's samples (sorted in place)
+struct Dist {
+    long long mn, med, p99;
+};
+
+Dist dist_of(vector<long long> &v) {
+    sort(v.begin(), v.end());
+    Dist d;
+    d.mn = v.front();
+    d.med = v[v.size() / 2];
+    d.p99 = v[min(v.size() - 1, (size_t)(v.size() * 99 / 100))];
+    return d;
+}
+
+int main(int argc, char *argv[]) {
+    string filename;
+    int iters = 10;
+    int warmup = 3;
+    bool extended = false;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--iters" && i + 1 < argc) {
+            iters = atoi(argv[++i]);
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            warmup = atoi(argv[++i]);
+        } else if (arg == "--extended") {
+            extended = true;
+        } else {
+            filename = arg;
+        }
+    }
+    if (iters < 1) iters = 1;
+    if (warmup < 0) warmup = 0;
+
+    if (filename.empty()) {
+        cerr << "Usage: sudoku_bench [--iters N] [--warmup N] [--extended]"
+                " puzzlefile\n";
+        return 1;
+    }
+
+    sudsat::PuzzleSource src;
+    if (!src.open(filename)) {
+        cerr << "Error: cannot open puzzle file " << filename << "\n";
+        return 1;
+    }
+    vector<string> puzzles; // owned copies: views must survive the run
+    const char *p;
+    while ((p = src.next()) != nullptr) {
+        puzzles.push_back(string(p, 81));
+    }
+    if (src.bad_line() != 0) {
+        cerr << "Error: malformed puzzle on line " << src.bad_line() << "\n";
+        return 1;
+    }
+    if (puzzles.empty()) {
+        cerr << "Error: no puzzles in " << filename << "\n";
+        return 1;
+    }
+
+    // template built (and timed) once, like the production encoder
+    sudsat::ClauseStore structural;
+    Clock::time_point t0 = Clock::now();
+    Enc::add_structural(structural);
+    if (extended) {
+        Enc::add_extended(structural);
+    }
+    long long template_ns = ns_since(t0);
+
+    cout << "# encoding: " << (extended ? "extended" : "minimal")
+         << ", puzzles: " << puzzles.size()
+         << ", iters: " << iters << " (+" << warmup << " warmup)\n";
+    cout << "# template build: " << template_ns / 1000 << " us, "
+         << structural.size() << " clauses\n";
+    cout << "# per-puzzle times in us: "
+            "encode(min/med/p99) solve(min/med/p99) decode(min/med/p99)\n";
+
+    sudsat::DimacsWriter writer;
+    long long grand_total_ns = 0;
+    // consumes every decoded frame so the timed model scan above has a
+    // live use and cannot be dead-code-eliminated at -O2
+    unsigned long long checksum = 0;
+
+    for (size_t pi = 0; pi < puzzles.size(); ++pi) {
+        int grid[9][9];
+        if (!sudsat::parse_grid81(puzzles[pi].c_str(), grid)) {
+            cerr << "Error: bad puzzle " << (pi + 1) << "\n";
+            return 1;
+        }
+
+        vector<long long> enc_ns, solve_ns, dec_ns;
+        char frame[90];
+
+        for (int it = -warmup; it < iters; ++it) {
+            // encode: givens + full DIMACS emission into memory
+            t0 = Clock::now();
+            sudsat::ClauseStore givens;
+            for (int r = 1; r <= NUM_ROWS; ++r) {
+                for (int c = 1; c <= NUM_COLS; ++c) {
+                    int d = grid[r - 1][c - 1];
+                    if (d != 0) {
+                        givens.add({ varnum(r, c, d) });
+                    }
+                }
+            }
+            writer.clear();
+            writer.header(NUM_VARS, structural.size() + givens.size());
+            for (const auto &cl : structural) writer.clause(cl);
+            for (const auto &cl : givens) writer.clause(cl);
+            long long t_enc = ns_since(t0);
+
+            // solve: fresh solver fed from the in-memory stores
+            t0 = Clock::now();
+            sudsat::Solver solver(NUM_VARS);
+            for (const auto &cl : structural) {
+                solver.add_clause(cl.begin(), cl.size());
+            }
+            for (const auto &cl : givens) {
+                solver.add_clause(cl.begin(), cl.size());
+            }
+            bool sat = solver.solve();
+            long long t_solve = ns_since(t0);
+
+            // decode: model -> 81-digit frame
+            t0 = Clock::now();
+            if (sat) {
+                for (int r = 1; r <= NUM_ROWS; ++r) {
+                    for (int c = 1; c <= NUM_COLS; ++c) {
+                        for (int d = 1; d <= NUM_DIGITS; ++d) {
+                            if (solver.model(varnum(r, c, d)) == 1) {
+                                frame[(r - 1) * 9 + (c - 1)] =
+                                    (char)('0' + d);
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+            long long t_dec = ns_since(t0);
+
+            if (!sat) {
+                cerr << "UNSAT: puzzle " << (pi + 1) << "\n";
+                return 1;
+            }
+            for (int k = 0; k < 81; ++k) {
+                checksum += (unsigned char)frame[k];
+            }
+            if (it >= 0) {
+                enc_ns.push_back(t_enc);
+                solve_ns.push_back(t_solve);
+                dec_ns.push_back(t_dec);
+                grand_total_ns += t_enc + t_solve + t_dec;
+            }
+        }
+
+        Dist e = dist_of(enc_ns), s = dist_of(solve_ns), d = dist_of(dec_ns);
+        cout << "puzzle " << (pi + 1) << ": "
+             << e.mn / 1000 << "/" << e.med / 1000 << "/" << e.p99 / 1000
+             << " "
+             << s.mn / 1000 << "/" << s.med / 1000 << "/" << s.p99 / 1000
+             << " "
+             << d.mn / 1000 << "/" << d.med / 1000 << "/" << d.p99 / 1000
+             << "\n";
+    }
+
+    double secs = grand_total_ns / 1e9;
+    double per_iter = secs / iters;
+    cout << "# total measured: " << secs << " s, throughput: "
+         << (per_iter > 0 ? puzzles.size() / per_iter : 0)
+         << " puzzles/s (single thread), frame checksum: "
+         << checksum << "\n";
+
+    return 0;
+}
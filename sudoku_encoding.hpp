@@ -0,0 +1,409 @@
+// sudoku_encoding.hpp
+//
+// The Sudoku -> CNF encoding builders, parameterized by box size so
+// larger boards compile to fully specialized encoders: Box = 3 is the
+// classic 9x9 board (729 variables), Box = 4 is 16x16, Box = 5 is
+// 25x25. varnum is constexpr and every loop bound is a compile-time
+// constant, so each instantiation inlines to straight-line clause
+// generation — the per-clause overhead that is tolerable at 9x9 would
+// not be at the hundreds of thousands of clauses a 25x25 board emits.
+//
+// All builders append into a caller-supplied ClauseStore; digit/row/
+// column indices are 1-based like the original sud2sat encoding.
+
+#ifndef SUDOKU_SAT_SUDOKU_ENCODING_HPP
+#define SUDOKU_SAT_SUDOKU_ENCODING_HPP
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "clause_store.hpp"
+
+namespace sudsat {
+
+template <int Box>
+struct Encoding {
+    static const int N = Box * Box;      // board side / digit count
+    static const int NUM_CELLS = N * N;
+    static const int NUM_VARS = N * N * N;
+
+    // variable for "cell (r,c) contains digit d", r,c,d in [1..N]
+    static constexpr int varnum(int r, int c, int d) {
+        return N * N * (r - 1) + N * (c - 1) + d;
+    }
+
+    // --- minimal encoding ---
+
+    // each cell has at least one digit
+    static void add_cell_at_least_one(ClauseStore &cs) {
+        for (int r = 1; r <= N; ++r) {
+            for (int c = 1; c <= N; ++c) {
+                for (int d = 1; d <= N; ++d) {
+                    cs.push_literal(varnum(r, c, d));
+                }
+                cs.end_clause();
+            }
+        }
+    }
+
+    // each digit at most once per row
+    static void add_row_at_most_one(ClauseStore &cs) {
+        for (int r = 1; r <= N; ++r) {
+            for (int d = 1; d <= N; ++d) {
+                for (int c1 = 1; c1 < N; ++c1) {
+                    for (int c2 = c1 + 1; c2 <= N; ++c2) {
+                        cs.add({ -varnum(r, c1, d), -varnum(r, c2, d) });
+                    }
+                }
+            }
+        }
+    }
+
+    // each digit at most once per column
+    static void add_col_at_most_one(ClauseStore &cs) {
+        for (int c = 1; c <= N; ++c) {
+            for (int d = 1; d <= N; ++d) {
+                for (int r1 = 1; r1 < N; ++r1) {
+                    for (int r2 = r1 + 1; r2 <= N; ++r2) {
+                        cs.add({ -varnum(r1, c, d), -varnum(r2, c, d) });
+                    }
+                }
+            }
+        }
+    }
+
+    // each digit at most once per Box x Box box
+    static void add_box_at_most_one(ClauseStore &cs) {
+        for (int br = 0; br < Box; ++br) {
+            for (int bc = 0; bc < Box; ++bc) {
+                for (int d = 1; d <= N; ++d) {
+                    for (int i = 0; i < N; ++i) {
+                        for (int j = i + 1; j < N; ++j) {
+                            int r1 = Box * br + i / Box + 1;
+                            int c1 = Box * bc + i % Box + 1;
+                            int r2 = Box * br + j / Box + 1;
+                            int c2 = Box * bc + j % Box + 1;
+                            cs.add({ -varnum(r1, c1, d),
+                                     -varnum(r2, c2, d) });
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // the full minimal structural set, in sud2sat's clause order
+    static void add_structural(ClauseStore &cs) {
+        add_cell_at_least_one(cs);
+        add_row_at_most_one(cs);
+        add_col_at_most_one(cs);
+        add_box_at_most_one(cs);
+    }
+
+    // --- alternative at-most-one encodings ---
+    //
+    // The pairwise builders above emit N*(N-1)/2 binary clauses per
+    // group, which grows quadratically with board size. The sequential
+    // (Sinz) and commander encodings trade auxiliary variables for a
+    // linear clause count per group. Both take the next free variable
+    // number and return the new high-water mark.
+
+    // sequential at-most-one over lits[0..n-1] using n-1 aux vars
+    static int amo_sequential(const int *lits, int n, int next_var,
+                              ClauseStore &cs) {
+        if (n <= 1) {
+            return next_var;
+        }
+        // s_i = "some literal among lits[0..i] is true"
+        int s_prev = next_var++;
+        cs.add({ -lits[0], s_prev });
+        for (int i = 1; i < n - 1; ++i) {
+            int s_i = next_var++;
+            cs.add({ -lits[i], s_i });
+            cs.add({ -s_prev, s_i });
+            cs.add({ -lits[i], -s_prev });
+            s_prev = s_i;
+        }
+        cs.add({ -lits[n - 1], -s_prev });
+        return next_var;
+    }
+
+    // commander at-most-one: split into groups of Box, pairwise inside
+    // each group, one commander variable per group, pairwise over the
+    // commanders
+    static int amo_commander(const int *lits, int n, int next_var,
+                             ClauseStore &cs) {
+        if (n <= Box + 1) {
+            // too small to be worth splitting
+            for (int i = 0; i < n; ++i) {
+                for (int j = i + 1; j < n; ++j) {
+                    cs.add({ -lits[i], -lits[j] });
+                }
+            }
+            return next_var;
+        }
+
+        int commanders[N]; // at most N/Box groups
+        int ng = 0;
+        for (int g = 0; g < n; g += Box) {
+            int end = g + Box < n ? g + Box : n;
+            // pairwise inside the group
+            for (int i = g; i < end; ++i) {
+                for (int j = i + 1; j < end; ++j) {
+                    cs.add({ -lits[i], -lits[j] });
+                }
+            }
+            // commander is implied by any group member
+            int cmd = next_var++;
+            for (int i = g; i < end; ++i) {
+                cs.add({ -lits[i], cmd });
+            }
+            commanders[ng++] = cmd;
+        }
+        // at most one commander
+        for (int i = 0; i < ng; ++i) {
+            for (int j = i + 1; j < ng; ++j) {
+                cs.add({ -commanders[i], -commanders[j] });
+            }
+        }
+        return next_var;
+    }
+
+    enum AmoKind { AMO_PAIRWISE, AMO_SEQUENTIAL, AMO_COMMANDER };
+
+    static int amo(const int *lits, int n, int next_var, ClauseStore &cs,
+                   AmoKind kind) {
+        switch (kind) {
+        case AMO_SEQUENTIAL:
+            return amo_sequential(lits, n, next_var, cs);
+        case AMO_COMMANDER:
+            return amo_commander(lits, n, next_var, cs);
+        default:
+            for (int i = 0; i < n; ++i) {
+                for (int j = i + 1; j < n; ++j) {
+                    cs.add({ -lits[i], -lits[j] });
+                }
+            }
+            return next_var;
+        }
+    }
+
+    // minimal structural set with a selectable at-most-one strategy;
+    // returns the total variable count (NUM_VARS plus any auxiliaries)
+    static int add_structural_amo(ClauseStore &cs, AmoKind kind) {
+        add_cell_at_least_one(cs);
+
+        int next_var = NUM_VARS + 1;
+        int lits[N];
+
+        // rows
+        for (int r = 1; r <= N; ++r) {
+            for (int d = 1; d <= N; ++d) {
+                for (int c = 1; c <= N; ++c) {
+                    lits[c - 1] = varnum(r, c, d);
+                }
+                next_var = amo(lits, N, next_var, cs, kind);
+            }
+        }
+        // columns
+        for (int c = 1; c <= N; ++c) {
+            for (int d = 1; d <= N; ++d) {
+                for (int r = 1; r <= N; ++r) {
+                    lits[r - 1] = varnum(r, c, d);
+                }
+                next_var = amo(lits, N, next_var, cs, kind);
+            }
+        }
+        // boxes
+        for (int br = 0; br < Box; ++br) {
+            for (int bc = 0; bc < Box; ++bc) {
+                for (int d = 1; d <= N; ++d) {
+                    for (int i = 0; i < N; ++i) {
+                        lits[i] = varnum(Box * br + i / Box + 1,
+                                         Box * bc + i % Box + 1, d);
+                    }
+                    next_var = amo(lits, N, next_var, cs, kind);
+                }
+            }
+        }
+        return next_var - 1;
+    }
+
+    // --- extended (redundant) encoding, sud2sat1's additions ---
+
+    // each cell has at most one digit
+    static void add_cell_at_most_one(ClauseStore &cs) {
+        for (int r = 1; r <= N; ++r) {
+            for (int c = 1; c <= N; ++c) {
+                for (int d1 = 1; d1 < N; ++d1) {
+                    for (int d2 = d1 + 1; d2 <= N; ++d2) {
+                        cs.add({ -varnum(r, c, d1), -varnum(r, c, d2) });
+                    }
+                }
+            }
+        }
+    }
+
+    // each digit at least once per row
+    static void add_row_at_least_one(ClauseStore &cs) {
+        for (int r = 1; r <= N; ++r) {
+            for (int d = 1; d <= N; ++d) {
+                for (int c = 1; c <= N; ++c) {
+                    cs.push_literal(varnum(r, c, d));
+                }
+                cs.end_clause();
+            }
+        }
+    }
+
+    // each digit at least once per column
+    static void add_col_at_least_one(ClauseStore &cs) {
+        for (int c = 1; c <= N; ++c) {
+            for (int d = 1; d <= N; ++d) {
+                for (int r = 1; r <= N; ++r) {
+                    cs.push_literal(varnum(r, c, d));
+                }
+                cs.end_clause();
+            }
+        }
+    }
+
+    // each digit at least once per box
+    static void add_box_at_least_one(ClauseStore &cs) {
+        for (int br = 0; br < Box; ++br) {
+            for (int bc = 0; bc < Box; ++bc) {
+                for (int d = 1; d <= N; ++d) {
+                    for (int i = 0; i < N; ++i) {
+                        cs.push_literal(varnum(Box * br + i / Box + 1,
+                                               Box * bc + i % Box + 1, d));
+                    }
+                    cs.end_clause();
+                }
+            }
+        }
+    }
+
+    // the redundant constraint set, in sud2sat1's clause order
+    static void add_extended(ClauseStore &cs) {
+        add_cell_at_most_one(cs);
+        add_row_at_least_one(cs);
+        add_col_at_least_one(cs);
+        add_box_at_least_one(cs);
+    }
+
+    // unit clauses for the clues; grid is row-major [N][N], 0 = empty
+    static void add_givens(const int *grid, ClauseStore &cs) {
+        for (int r = 1; r <= N; ++r) {
+            for (int c = 1; c <= N; ++c) {
+                int d = grid[(r - 1) * N + (c - 1)];
+                if (1 <= d && d <= N) {
+                    cs.add({ varnum(r, c, d) });
+                }
+            }
+        }
+    }
+};
+
+// the classic 9x9 board used by the whole pipeline
+typedef Encoding<3> Encoding9;
+
+// character-class kernel shared by the grid parsers: 81 puzzle bytes
+// to digit bytes (0 for the '0'/'.'/'*'/'?' wildcards), rejecting any
+// other character. With SSE2 each 16-byte chunk is classified
+// branchlessly — one subtract gives the digit values, two compares
+// mark 1..9, four mark the wildcards, and a single movemask validates
+// the whole chunk — so bulk parsing off the mmap reader runs at memory
+// bandwidth instead of a byte-at-a-time if/else chain.
+inline bool parse_digits81(const char *all, unsigned char out[81]) {
+    int k = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ten = _mm_set1_epi8(10);
+    for (; k + 16 <= 81; k += 16) {
+        __m128i ch = _mm_loadu_si128((const __m128i *)(all + k));
+        __m128i d = _mm_sub_epi8(ch, _mm_set1_epi8('0'));
+        __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(d, zero),
+                                         _mm_cmpgt_epi8(ten, d));
+        __m128i wild = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(ch, _mm_set1_epi8('.')),
+                         _mm_cmpeq_epi8(ch, _mm_set1_epi8('0'))),
+            _mm_or_si128(_mm_cmpeq_epi8(ch, _mm_set1_epi8('*')),
+                         _mm_cmpeq_epi8(ch, _mm_set1_epi8('?'))));
+        if (_mm_movemask_epi8(_mm_or_si128(is_digit, wild)) != 0xffff) {
+            return false;
+        }
+        _mm_storeu_si128((__m128i *)(out + k),
+                         _mm_and_si128(d, is_digit));
+    }
+#endif
+    for (; k < 81; ++k) {
+        char ch = all[k];
+        if (ch >= '1' && ch <= '9') {
+            out[k] = (unsigned char)(ch - '0');
+        } else if (ch == '0' || ch == '.' || ch == '*' || ch == '?') {
+            out[k] = 0; // wildcard = empty
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// parse one 81-character 9x9 puzzle (digits 1-9 for clues; 0, '.', '*'
+// or '?' for empty cells) into a row-major grid. Returns false on any
+// other character.
+inline bool parse_grid81(const char *all, int grid[9][9]) {
+    unsigned char d[81];
+    if (!parse_digits81(all, d)) {
+        return false;
+    }
+    for (int k = 0; k < 81; ++k) {
+        grid[k / 9][k % 9] = d[k];
+    }
+    return true;
+}
+
+// one-pass variant that also yields the per-cell candidate bitmask the
+// propagation engine starts from: a clue's single digit bit, 0x3fe
+// (digits 1..9) for an empty cell.
+inline bool parse_grid81_masks(const char *all, int grid[9][9],
+                               int cand[9][9]) {
+    unsigned char d[81];
+    if (!parse_digits81(all, d)) {
+        return false;
+    }
+    for (int k = 0; k < 81; ++k) {
+        grid[k / 9][k % 9] = d[k];
+        cand[k / 9][k % 9] = d[k] != 0 ? (1 << d[k]) : 0x3fe;
+    }
+    return true;
+}
+
+// O(81) consistency check on the clues: no digit twice in any row,
+// column, or box. Corrupt puzzles in a feed would otherwise cost a
+// full encode + solve cycle just to come back UNSAT.
+inline bool givens_consistent(const int grid[9][9]) {
+    int row[9] = {}, col[9] = {}, box[9] = {};
+    for (int r = 0; r < 9; ++r) {
+        for (int c = 0; c < 9; ++c) {
+            int d = grid[r][c];
+            if (d == 0) {
+                continue;
+            }
+            int bit = 1 << d;
+            int b = r / 3 * 3 + c / 3;
+            if ((row[r] | col[c] | box[b]) & bit) {
+                return false;
+            }
+            row[r] |= bit;
+            col[c] |= bit;
+            box[b] |= bit;
+        }
+    }
+    return true;
+}
+
+} // namespace sudsat
+
+#endif // SUDOKU_SAT_SUDOKU_ENCODING_HPP
@@ -0,0 +1,248 @@
+// sudoku_gen.cpp
+//
+// Benchmark dataset generator: streams valid puzzles as 81-character
+// lines (top95 style, '.' for empty cells) at a chosen clue count.
+// A complete base grid is produced by solving a random seed — the
+// three diagonal boxes filled with random permutations, completed by
+// the pipeline's own solver — and each output puzzle applies a random
+// validity-preserving transformation of that grid (digit relabeling,
+// row/column swaps within bands, band swaps, transposition) before
+// punching clues out, so between the periodic SAT-solved reseeds the
+// stream runs at memory bandwidth. The shipped datasets (95 + 50
+// puzzles) are far too small to exercise cache behavior, threading, or
+// tail latency; this makes runs of millions cheap.
+//
+// --unique keeps each puzzle's solution unique: a removal that admits
+// a second solution (checked by solving with the known solution
+// blocked) is undone. That costs a solver call per punched cell, so
+// use it for curated sets, not bulk streams.
+//
+// Usage: sudoku_gen [--count N] [--clues K] [--seed S] [--unique]
+
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <random>
+#include <algorithm>
+
+#include <unistd.h>
+
+#include "clause_store.hpp"
+#include "propagation.hpp"
+#include "solver/solver.hpp"
+#include "sudoku_encoding.hpp"
+
+using namespace std;
+
+typedef sudsat::Encoding9 Enc;
+
+// new base grids are solved from scratch this often; between reseeds
+// the transformation group supplies the variety
+static const int RESEED_EVERY = 256;
+
+mt19937_64 rng;
+
+const sudsat::ClauseStore &structural_clauses() {
+    static sudsat::ClauseStore tmpl = [] {
+        sudsat::ClauseStore cs;
+        Enc::add_structural(cs);
+        return cs;
+    }();
+    return tmpl;
+}
+
+// complete grid from a random seed: random permutations in the three
+// diagonal boxes (always mutually consistent), completed by the solver
+bool solve_base_grid(int grid[9][9]) {
+    int seed[9][9] = {};
+    int digits[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    for (int b = 0; b < 3; ++b) {
+        shuffle(digits, digits + 9, rng);
+        for (int i = 0; i < 9; ++i) {
+            seed[b * 3 + i / 3][b * 3 + i % 3] = digits[i];
+        }
+    }
+
+    sudsat::Solver solver(Enc::NUM_VARS);
+    for (const auto &cl : structural_clauses()) {
+        solver.add_clause(cl.begin(), cl.size());
+    }
+    for (int r = 1; r <= 9; ++r) {
+        for (int c = 1; c <= 9; ++c) {
+            int d = seed[r - 1][c - 1];
+            if (d != 0) {
+                int lit = Enc::varnum(r, c, d);
+                if (!solver.add_clause(&lit, 1)) {
+                    return false;
+                }
+            }
+        }
+    }
+    if (!solver.solve()) {
+        return false;
+    }
+    for (int r = 1; r <= 9; ++r) {
+        for (int c = 1; c <= 9; ++c) {
+            for (int d = 1; d <= 9; ++d) {
+                if (solver.model(Enc::varnum(r, c, d)) == 1) {
+                    grid[r - 1][c - 1] = d;
+                    break;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// random validity-preserving transformation: these generate a large
+// subgroup of the grid symmetry group, enough that successive outputs
+// from one base grid are effectively unrelated puzzles
+void transform_grid(const int in[9][9], int out[9][9]) {
+    int relabel[10] = { 0 };
+    for (int d = 1; d <= 9; ++d) relabel[d] = d;
+    shuffle(relabel + 1, relabel + 10, rng);
+
+    // permute rows within each band and the bands themselves; same for
+    // columns via the stacks
+    int rowmap[9], colmap[9];
+    int band[3] = { 0, 1, 2 }, stack[3] = { 0, 1, 2 };
+    shuffle(band, band + 3, rng);
+    shuffle(stack, stack + 3, rng);
+    for (int b = 0; b < 3; ++b) {
+        int rows[3] = { 0, 1, 2 }, cols[3] = { 0, 1, 2 };
+        shuffle(rows, rows + 3, rng);
+        shuffle(cols, cols + 3, rng);
+        for (int i = 0; i < 3; ++i) {
+            rowmap[b * 3 + i] = band[b] * 3 + rows[i];
+            colmap[b * 3 + i] = stack[b] * 3 + cols[i];
+        }
+    }
+    bool transpose = (rng() & 1) != 0;
+
+    for (int r = 0; r < 9; ++r) {
+        for (int c = 0; c < 9; ++c) {
+            int v = relabel[in[rowmap[r]][colmap[c]]];
+            if (transpose) {
+                out[c][r] = v;
+            } else {
+                out[r][c] = v;
+            }
+        }
+    }
+}
+
+// does `puzzle` admit a solution other than `solution`? Solved with a
+// clause blocking the known solution's 81 cell variables.
+bool has_second_solution(const int puzzle[9][9], const int solution[9][9]) {
+    sudsat::Solver solver(Enc::NUM_VARS);
+    for (const auto &cl : structural_clauses()) {
+        solver.add_clause(cl.begin(), cl.size());
+    }
+    bool ok = true;
+    for (int r = 1; r <= 9 && ok; ++r) {
+        for (int c = 1; c <= 9 && ok; ++c) {
+            int d = puzzle[r - 1][c - 1];
+            if (d != 0) {
+                int lit = Enc::varnum(r, c, d);
+                ok = solver.add_clause(&lit, 1);
+            }
+        }
+    }
+    if (!ok) {
+        return false;
+    }
+    int block[81];
+    for (int r = 1; r <= 9; ++r) {
+        for (int c = 1; c <= 9; ++c) {
+            block[(r - 1) * 9 + (c - 1)] =
+                -Enc::varnum(r, c, solution[r - 1][c - 1]);
+        }
+    }
+    if (!solver.add_clause(block, 81)) {
+        return false;
+    }
+    return solver.solve();
+}
+
+int main(int argc, char *argv[]) {
+    long long count = 100;
+    int clues = 30;
+    unsigned long long seed = 1;
+    bool unique = false;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--count" && i + 1 < argc) {
+            count = atoll(argv[++i]);
+        } else if (arg == "--clues" && i + 1 < argc) {
+            clues = atoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--unique") {
+            unique = true;
+        } else {
+            cerr << "Usage: sudoku_gen [--count N] [--clues K]"
+                    " [--seed S] [--unique]\n";
+            return 1;
+        }
+    }
+    if (clues < 17) clues = 17; // no unique 9x9 puzzle has fewer
+    if (clues > 81) clues = 81;
+
+    rng.seed(seed);
+
+    // output accumulates in a big buffer flushed with plain write()s,
+    // so the hot loop never touches iostream formatting
+    string out;
+    out.reserve(1 << 20);
+
+    int base[9][9];
+    int full[9][9];
+    int puzzle[9][9];
+    int order[81];
+    for (int k = 0; k < 81; ++k) order[k] = k;
+
+    for (long long n = 0; n < count; ++n) {
+        if (n % RESEED_EVERY == 0) {
+            if (!solve_base_grid(base)) {
+                cerr << "Error: seed grid unsolvable (internal)\n";
+                return 1;
+            }
+        }
+        transform_grid(base, full);
+
+        // punch cells out in random order down to the clue target
+        memcpy(puzzle, full, sizeof(puzzle));
+        shuffle(order, order + 81, rng);
+        int remaining = 81;
+        for (int k = 0; k < 81 && remaining > clues; ++k) {
+            int r = order[k] / 9, c = order[k] % 9;
+            int d = puzzle[r][c];
+            puzzle[r][c] = 0;
+            if (unique && has_second_solution(puzzle, full)) {
+                puzzle[r][c] = d; // removal broke uniqueness; undo
+            } else {
+                --remaining;
+            }
+        }
+
+        for (int k = 0; k < 81; ++k) {
+            int d = puzzle[k / 9][k % 9];
+            out.push_back(d == 0 ? '.' : (char)('0' + d));
+        }
+        out.push_back('\n');
+
+        if (out.size() >= (1 << 20) - 128) {
+            if (write(STDOUT_FILENO, out.data(), out.size()) < 0) {
+                return 1;
+            }
+            out.clear();
+        }
+    }
+
+    if (!out.empty()
+        && write(STDOUT_FILENO, out.data(), out.size()) < 0) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,347 @@
+// sudoku_solve.cpp
+//
+// Single-binary pipeline replacing the solve.sh process chain:
+// read -> encode -> solve -> decode -> print entirely in memory, with
+// no intermediate .cnf/assign.txt/solution.txt files and no external
+// minisat. Reads one puzzle from a file argument or stdin (same
+// 81-character format as sud2sat, whitespace ignored) and prints the
+// solved grid as 9 lines of 9 digits.
+//
+// A bitmask propagation pre-solver runs first: puzzles it cracks
+// outright never touch the CNF machinery, and for the rest every cell
+// it pins down becomes an extra given, shrinking the SAT search.
+//
+// Daemon mode amortizes startup across requests: the process starts
+// once, pre-builds the structural clause template, then serves one
+// puzzle per line — over stdin with --daemon, or over a Unix socket
+// with --socket path. Each request is answered with the 9-line
+// solution, or a single "UNSAT" / "ERROR" line.
+//
+// The daemon keeps a content-addressed solution cache (the workload
+// repeats popular puzzles heavily); --cache file backs it with a
+// persistent append-only file shared across runs and modes.
+//
+// Usage: sudoku_solve [--extended] [--no-presolve] [--cache file]
+//                     [puzzlefile]
+//        sudoku_solve [options] --daemon
+//        sudoku_solve [options] --socket /path/to.sock
+
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <cctype>
+#include <csignal>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "clause_store.hpp"
+#include "propagation.hpp"
+#include "solution_cache.hpp"
+#include "solver/solver.hpp"
+#include "sudoku_encoding.hpp"
+
+using namespace std;
+
+typedef sudsat::Encoding9 Enc;
+
+// the structural template for the selected encoding, built on first use
+static bool opt_extended = false;
+static bool opt_presolve = true;
+
+const sudsat::ClauseStore &structural_clauses() {
+    static sudsat::ClauseStore tmpl = [] {
+        sudsat::ClauseStore cs;
+        Enc::add_structural(cs);
+        if (opt_extended) {
+            Enc::add_extended(cs);
+        }
+        return cs;
+    }();
+    return tmpl;
+}
+
+bool read_grid(istream &in, int grid[9][9]) {
+    string all;
+    string line;
+    while (getline(in, line)) {
+        for (unsigned char ch : line) {
+            if (!isspace(ch)) {
+                all.push_back(ch);
+            }
+        }
+    }
+    if ((int)all.size() != 81) {
+        cerr << "Error: expected exactly 81 non-whitespace characters, got "
+             << all.size() << "\n";
+        return false;
+    }
+    if (!sudsat::parse_grid81(all.data(), grid)) {
+        cerr << "Error: invalid character in puzzle\n";
+        return false;
+    }
+    return true;
+}
+
+string format_grid(const int grid[9][9]) {
+    string out;
+    out.reserve(90);
+    for (int r = 0; r < 9; ++r) {
+        for (int c = 0; c < 9; ++c) {
+            out.push_back((char)('0' + grid[r][c]));
+        }
+        out.push_back('\n');
+    }
+    return out;
+}
+
+// the whole pipeline for one grid; returns the 9-line solution text,
+// or "" if the puzzle has no solution
+string solve_grid(const int grid[9][9]) {
+    // fast path: most easy puzzles fall to propagation alone, and any
+    // cell it forces is a free given for the SAT fallback
+    int forced[9][9];
+    if (opt_presolve) {
+        sudsat::PropagationResult pr = sudsat::propagate_grid(grid, forced);
+        if (pr.contradiction) {
+            return "";
+        }
+        if (pr.solved) {
+            return format_grid(forced);
+        }
+    } else {
+        for (int r = 0; r < 9; ++r) {
+            for (int c = 0; c < 9; ++c) {
+                forced[r][c] = grid[r][c];
+            }
+        }
+    }
+
+    sudsat::Solver solver(Enc::NUM_VARS);
+    const sudsat::ClauseStore &tmpl = structural_clauses();
+    for (const auto &cl : tmpl) {
+        solver.add_clause(cl.begin(), cl.size());
+    }
+
+    bool ok = true;
+    for (int r = 1; r <= 9 && ok; ++r) {
+        for (int c = 1; c <= 9 && ok; ++c) {
+            int d = forced[r - 1][c - 1];
+            if (d != 0) {
+                int lit = Enc::varnum(r, c, d);
+                ok = solver.add_clause(&lit, 1);
+            }
+        }
+    }
+
+    if (!ok || !solver.solve()) {
+        return "";
+    }
+
+    string out;
+    out.reserve(90);
+    for (int r = 1; r <= 9; ++r) {
+        for (int c = 1; c <= 9; ++c) {
+            for (int d = 1; d <= 9; ++d) {
+                if (solver.model(Enc::varnum(r, c, d)) == 1) {
+                    out.push_back((char)('0' + d));
+                    break;
+                }
+            }
+        }
+        out.push_back('\n');
+    }
+    return out;
+}
+
+// content-addressed solution cache: always on in daemon mode (that is
+// where the repeated-puzzle traffic lives), persistent with --cache
+sudsat::SolutionCache cache;
+bool opt_cache = false;
+
+// cache-aware front of the pipeline: a hit skips encoding and solving
+// entirely; a miss solves and stores the 81-digit solution
+string solve_cached(const int grid[9][9]) {
+    if (!opt_cache) {
+        return solve_grid(grid);
+    }
+    string key = sudsat::SolutionCache::canonical(grid);
+    if (const string *hit = cache.lookup(key)) {
+        string out;
+        out.reserve(90);
+        for (int r = 0; r < 9; ++r) {
+            out.append(*hit, r * 9, 9);
+            out.push_back('\n');
+        }
+        return out;
+    }
+    string sol = solve_grid(grid);
+    if (!sol.empty()) {
+        string flat;
+        flat.reserve(81);
+        for (char ch : sol) {
+            if (ch != '\n') {
+                flat.push_back(ch);
+            }
+        }
+        cache.insert(key, flat);
+    }
+    return sol;
+}
+
+// serve one request line: an 81-character puzzle in, the 9-line
+// solution (or "UNSAT" / "ERROR") out
+string serve_line(const string &line) {
+    int grid[9][9];
+    if (line.size() != 81 || !sudsat::parse_grid81(line.data(), grid)) {
+        return "ERROR\n";
+    }
+    if (!sudsat::givens_consistent(grid)) {
+        return "UNSAT\n";
+    }
+    string sol = solve_cached(grid);
+    return sol.empty() ? "UNSAT\n" : sol;
+}
+
+// stdin daemon: one puzzle per line, response flushed per request so a
+// front-end can pipeline over the same pair of pipes indefinitely
+int run_daemon_stdin() {
+    structural_clauses(); // pre-build the template before serving
+    string line;
+    while (getline(cin, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        cout << serve_line(line) << flush;
+    }
+    return 0;
+}
+
+// Unix socket daemon: accept connections one at a time and answer one
+// puzzle per line until the client closes its end
+int run_daemon_socket(const string &path) {
+    structural_clauses();
+
+    // a client that disconnects before reading its response must not
+    // take the daemon down: with SIGPIPE ignored the write() below
+    // fails with EPIPE instead, and the connection loop moves on
+    signal(SIGPIPE, SIG_IGN);
+
+    int srv = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (srv < 0) {
+        cerr << "Error: cannot create socket\n";
+        return 1;
+    }
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        cerr << "Error: socket path too long: " << path << "\n";
+        return 1;
+    }
+    strcpy(addr.sun_path, path.c_str());
+    unlink(path.c_str()); // a stale socket from a previous run
+    if (bind(srv, (const sockaddr *)&addr, sizeof(addr)) < 0
+        || listen(srv, 16) < 0) {
+        cerr << "Error: cannot bind socket " << path << "\n";
+        return 1;
+    }
+
+    for (;;) {
+        int fd = accept(srv, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+        string pending;
+        char buf[4096];
+        ssize_t n;
+        while ((n = read(fd, buf, sizeof(buf))) > 0) {
+            pending.append(buf, n);
+            size_t nl;
+            while ((nl = pending.find('\n')) != string::npos) {
+                string line = pending.substr(0, nl);
+                pending.erase(0, nl + 1);
+                if (line.empty()) {
+                    continue;
+                }
+                string resp = serve_line(line);
+                const char *p = resp.data();
+                size_t left = resp.size();
+                while (left > 0) {
+                    ssize_t w = write(fd, p, left);
+                    if (w <= 0) {
+                        break;
+                    }
+                    p += w;
+                    left -= w;
+                }
+                if (left > 0) {
+                    break; // client gone mid-response (EPIPE)
+                }
+            }
+        }
+        close(fd);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    string filename;
+    string sockpath;
+    bool daemon = false;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--extended") {
+            opt_extended = true;
+        } else if (arg == "--no-presolve") {
+            opt_presolve = false;
+        } else if (arg == "--daemon") {
+            daemon = true;
+        } else if (arg == "--socket" && i + 1 < argc) {
+            sockpath = argv[++i];
+        } else if (arg == "--cache" && i + 1 < argc) {
+            opt_cache = true;
+            if (!cache.open(argv[++i])) {
+                cerr << "Error: cannot open cache file " << argv[i] << "\n";
+                return 1;
+            }
+        } else {
+            filename = arg;
+        }
+    }
+
+    if (!sockpath.empty()) {
+        opt_cache = true;
+        return run_daemon_socket(sockpath);
+    }
+    if (daemon) {
+        opt_cache = true;
+        return run_daemon_stdin();
+    }
+
+    istream *in = &cin;
+    static ifstream fin;
+    if (!filename.empty()) {
+        fin.open(filename.c_str());
+        if (!fin) {
+            cerr << "Error: cannot open puzzle file " << filename << "\n";
+            return 1;
+        }
+        in = &fin;
+    }
+
+    int grid[9][9];
+    if (!read_grid(*in, grid)) {
+        return 1;
+    }
+
+    string sol = solve_cached(grid);
+    if (sol.empty()) {
+        cerr << "UNSAT: puzzle has no solution.\n";
+        return 1;
+    }
+    cout << sol;
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+// timing.hpp
+//
+// Lightweight per-stage timing for the pipeline binaries. A disabled
+// StageTimings costs one branch per scope and never touches the clock,
+// so the instrumentation can stay in the hot paths permanently; with
+// --timing each stage's wall time is recorded and dumped as a single
+// machine-readable key=value line (nanoseconds) on request.
+
+#ifndef SUDOKU_SAT_TIMING_HPP
+#define SUDOKU_SAT_TIMING_HPP
+
+#include <chrono>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace sudsat {
+
+class StageTimings {
+public:
+    bool enabled = false;
+
+    // RAII scope: records elapsed ns against `name` on destruction.
+    // `name` must outlive the StageTimings (string literals in practice).
+    class Scope {
+    public:
+        Scope(StageTimings *t, const char *name) : t_(t), name_(name) {
+            if (t_ && t_->enabled) {
+                t0_ = std::chrono::steady_clock::now();
+            }
+        }
+        ~Scope() {
+            if (t_ && t_->enabled) {
+                long long ns =
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - t0_).count();
+                t_->add(name_, ns);
+            }
+        }
+        // movable so scope() compiles under C++11, where returning by
+        // value may call this instead of eliding; the moved-from scope
+        // is disarmed and records nothing
+        Scope(Scope &&other) : t_(other.t_), name_(other.name_),
+                               t0_(other.t0_) {
+            other.t_ = nullptr;
+        }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        StageTimings *t_;
+        const char *name_;
+        std::chrono::steady_clock::time_point t0_;
+    };
+
+    Scope scope(const char *name) { return Scope(this, name); }
+
+    // accumulate, so a stage hit once per puzzle in batch mode reports
+    // its total across the run
+    void add(const char *name, long long ns) {
+        for (auto &s : stages_) {
+            if (s.first == name) {
+                s.second += ns;
+                return;
+            }
+        }
+        stages_.push_back(std::make_pair(name, ns));
+    }
+
+    // one line, stage order preserved: "timing parse_ns=123 solve_ns=456"
+    void report(std::ostream &out) const {
+        if (!enabled || stages_.empty()) {
+            return;
+        }
+        out << "timing";
+        for (const auto &s : stages_) {
+            out << " " << s.first << "_ns=" << s.second;
+        }
+        out << "\n";
+    }
+
+private:
+    std::vector<std::pair<const char *, long long> > stages_;
+};
+
+} // namespace sudsat
+
+#endif // SUDOKU_SAT_TIMING_HPP